@@ -0,0 +1,111 @@
+/**
+ * @file   arena.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the bump allocator
+ *
+ * The usable memory of a block starts right after its header. A block used counter is only
+ * cleared when the arena moves into that block, which makes arena_reset O(1).
+ */
+
+#include "arena.h"
+
+/* Block header size rounded up to the alignment, so the first allocation is aligned */
+#define ARENA_HEADER_SIZE \
+    ((sizeof(arena_block_t) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+/**
+ * Initialise an empty arena. No memory is allocated until the first arena_alloc.
+ * @param arena pointer for the previously allocated arena.
+ */
+void arena_init(arena_t *arena)
+{
+    arena->head = NULL;
+    arena->current = NULL;
+}
+
+/**
+ * Free all blocks of the arena, and consequently every allocation made from it.
+ * @param arena pointer for the previously initialised arena.
+ */
+void arena_destroy(arena_t *arena)
+{
+    arena_block_t *block;
+    
+    while (arena->head != NULL)
+    {
+        block = arena->head;
+        arena->head = block->next;
+        free(block);
+    }
+    
+    arena->current = NULL;
+}
+
+/**
+ * Release every allocation made from the arena at once. The blocks are kept and reused by
+ * the following allocations.
+ * @param arena pointer for the previously initialised arena.
+ */
+void arena_reset(arena_t *arena)
+{
+    arena->current = arena->head;
+    
+    if (arena->current != NULL)
+        arena->current->used = 0;
+}
+
+/**
+ * Allocate memory from the arena. When the current block cannot hold the requested size,
+ * the arena moves to the next block, creating it if needed. Requests larger than
+ * ARENA_BLOCK_SIZE get a block of their own.
+ * @param arena pointer for the previously initialised arena.
+ * @param size number of bytes to allocate.
+ * @return pointer to the allocated memory, aligned to ARENA_ALIGNMENT.
+ */
+void* arena_alloc(arena_t *arena, int size)
+{
+    arena_block_t *block = arena->current;
+    arena_block_t *new_block;
+    int block_size;
+    void *ptr;
+    
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    
+    if ((block == NULL) || (block->used + size > block->size))
+    {
+        /* Reuse the next block when it is big enough, otherwise insert a new one */
+        if ((block != NULL) && (block->next != NULL) && (block->next->size >= size))
+        {
+            block = block->next;
+        }
+        else
+        {
+            block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+            new_block = malloc(ARENA_HEADER_SIZE + block_size);
+            new_block->size = block_size;
+            
+            if (block == NULL)
+            {
+                new_block->next = arena->head;
+                arena->head = new_block;
+            }
+            else
+            {
+                new_block->next = block->next;
+                block->next = new_block;
+            }
+            
+            block = new_block;
+        }
+        
+        block->used = 0;
+        arena->current = block;
+    }
+    
+    ptr = (char*)block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    
+    return ptr;
+}
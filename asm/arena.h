@@ -0,0 +1,67 @@
+/**
+ * @file   arena.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares a bump allocator for data that lives as long as its owner
+ *
+ * An arena hands out memory from large blocks by simply moving a pointer forward.
+ * Individual allocations are never freed; the whole arena is released at once, which
+ * avoids one malloc and one free for each small object.
+ *
+ * An arena may also outlive the data allocated from it and be reset once that data is
+ * gone, which releases every allocation in O(1) while keeping the blocks for the next
+ * allocations. Batch assembly lends each worker thread an arena that way: the interners of
+ * each file take their strings from it, and it is reset before the next file.
+ *
+ * Example usage
+ *
+    arena_t arena;
+    interner_t interner;
+    
+    arena_init(&arena);
+    interner_init_in_arena(&interner, &arena);
+    interner_intern(&interner, "LABEL", 5);
+    interner_destroy(&interner);
+    
+    arena_reset(&arena); (the strings are gone, the blocks are kept)
+    
+    arena_destroy(&arena);
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_BLOCK_SIZE 4096
+
+/* All allocations are aligned to this number of bytes */
+#define ARENA_ALIGNMENT sizeof(void*)
+
+struct arena_block_struct
+{
+    struct arena_block_struct *next;
+    int used;
+    int size;
+};
+typedef struct arena_block_struct arena_block_t;
+
+/*
+ * Blocks are kept in allocation order, from head to the last one. The current block is the
+ * one being filled; the blocks after it are either empty or left over from before the last
+ * reset, and are reused before allocating new ones.
+ */
+typedef struct
+{
+    arena_block_t *head;
+    arena_block_t *current;
+} arena_t;
+
+void arena_init(arena_t *arena);
+void arena_destroy(arena_t *arena);
+void arena_reset(arena_t *arena);
+void* arena_alloc(arena_t *arena, int size);
+
+#endif /* _ARENA_H_ */
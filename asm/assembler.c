@@ -12,54 +12,88 @@
  * The choice of a one-pass assembly implies in dealing with forward declarations
  * explicitly.
  *
- * The assembler uses four hash tables:
- * - Symbols table: stores every used symbol and the location in the object code of its 
- *                  last appearance.
- * - Instructions table: stores every valid instruction and its opcode.
- * - Directives table: stores every valid directive.
- * - Constants table: stores every label that points to a defined as a constant memory
- *                    address.
+ * Labels are interned, so the assembler refers to them by integer ids. It uses three
+ * tables:
+ * - Symbols table: stores every used symbol, indexed by label id, and the references made
+ *                  to labels before their definition, as fixups resolved in one sweep
+ *                  once the source code is over. Symbols also flag whether their label
+ *                  points to a constant memory address.
+ * - Instructions table: constant table of every valid instruction and its opcode.
+ * - Directives table: constant table of every valid directive.
+ *
+ * Instructions and directives are classified once, and every later decision is taken by
+ * switching on the opcode or directive instead of comparing names again.
  */
 
 #include "assembler.h"
 
-int write_compare(write_t *data, char *label)
-{
-    if (strcmp(data->label, label) == 0)
-        return 1;
-    return 0;
-}
-
 /**
  * Assemble a given source code input and writes the object file to the output file. It
  * first parses each line from the source and analyse its label, operation and operands.
  * Errors happen when an operation cannot be identified as an instruction nor as a
  * directive. Undefined labels and writing to constant memory addresses errors can only be
  * evaluated after parsing the whole source code.
- * @param input Source code file name.
+ * Lines are taken from the preprocessor in memory, already scanned, and errors refer to
+ * their line numbers in the source code.
+ * @param preprocessor Preprocessor which has scanned the source code.
  * @param output Object file name.
+ * @param listing_file Listing file name, or NULL for not writing it.
+ */
+void assemble(preprocessor_t *preprocessor, char *output, char *listing_file)
+{
+    assemble_object(preprocessor, output, listing_file, NULL, NULL);
+}
+
+/**
+ * Assemble a given source code input into a memory buffer instead of a file.
+ * @param preprocessor Preprocessor which has scanned the source code.
+ * @param buffer Stores the object file contents, which must be freed.
+ * @param size Stores the size of the object file, in bytes.
  */
-void assemble(char *input, char *output)
+void assemble_to_buffer(preprocessor_t *preprocessor, unsigned char **buffer,
+                        size_t *size)
 {
-    /* Source code file */
-    FILE *fp;
-    
-    /* Tables */
-    hash_table_t symbols_table;
-    hash_table_t instructions_table;
-    hash_table_t directives_table;
-    hash_table_t constants_table;
-    
-    /* Object file */
-    object_file_t object_file;
-    
-    /* Parse elements from the source code line */
-    element_t elements;
-    char line_buffer[FILE_LINE_LENGTH];
-    int instruction_size;
+    assemble_object(preprocessor, NULL, NULL, buffer, size);
+}
+
+/**
+ * Assemble a given source code input, as described for assemble. The object file is
+ * streamed to the output file as it grows, or kept in memory and written to a buffer once
+ * complete when no output file is given.
+ * Each line is only printed as progress when the assembly context keeps it. When a
+ * listing is requested, each line as written and the labels it refers to are recorded
+ * instead, and the listing is written once every fixup is resolved.
+ * @param preprocessor Preprocessor which has scanned the source code, keeping a copy of it
+ *                     as read when a listing is requested.
+ * @param output Object file name, or NULL for writing to the buffer.
+ * @param listing_file Listing file name, or NULL for not writing it.
+ * @param buffer Stores the object file contents when output is NULL.
+ * @param size Stores the size of the object file when output is NULL.
+ */
+void assemble_object(preprocessor_t *preprocessor, char *output, char *listing_file,
+                     unsigned char **buffer, size_t *size)
+{
+    /* Preprocessed source code line */
+    line_record_t record;
+    
+    /* Tables and object file, released even if an error stops assembling */
+    assembler_t *assembler = assembler_create();
+    symbols_table_t *symbols_table = &assembler->symbols_table;
+    interner_t *interner = &assembler->interner;
+    object_file_t *object_file = &assembler->object_file;
+    
+    /* Elements of the source code line, already scanned by the preprocessor */
+    element_t *elements = &record.elements;
+    const instruction_t *instruction_ptr;
     int is_instruction = 0;
     int is_directive = 0;
     int line_number = 0;
+    int address;
+    
+    /* Lines and references for the listing, or NULL when it is not written */
+    listing_t *listing = listing_file ? &assembler->listing : NULL;
+    source_line_t original;
+    int is_printing = context_has_progress();
     
     /* Current section (either text or data) */
     section_t section = SECTION_UNKNOWN;
@@ -69,408 +103,489 @@ void assemble(char *input, char *output)
     int is_text_section_defined = 0;
     
     /* Used for writing at constant memory checking */
-    list_t write_list;
-    int write_num = 0;
-    
-    list_create(&write_list, sizeof(write_t), (void*)write_compare, NULL);
+    bitmap_t *constants = &assembler->constants;
     
     /* Initializing */
-    init_tables(&symbols_table, &instructions_table, &directives_table, &constants_table);
-    object_file_init(&object_file);
-    element_init(&elements); /* Avoid garbage values at the label field by explicitly
-                                initialising */
-    fp = file_open(input, "r");
+    if (output)
+        object_file_open(object_file, output);
     
     /* Assembling */
-    printf("===== Assembling =====\n");
+    context_printf("===== Assembling =====\n");
     
-    while (file_read_line(fp, line_buffer) != FILE_FINISHED)
+    while (preprocessor_next_line(preprocessor, &record))
     {
         /* Reset variables */
         is_instruction = 0;
         is_directive = 0;
         
-        /* Update line number */
-        line_number += 1;
+        /* Update line number and address */
+        line_number = record.line.number;
+        address = object_file->size;
         
-        /* Scanning */
-        scan_line_elements(&elements, line_buffer);
-        printf("%15.15s | %15.15s | %15.15s | %15.15s\n", elements.label,
-               elements.operation, elements.operand1, elements.operand2);
+        if (is_printing)
+            element_print(elements);
         
         /* Label analysis */
-        if (element_has_label(&elements))
-            evaluate_label(&elements, &symbols_table, &object_file, line_number);
+        if (element_has_label(elements))
+            evaluate_label(elements, symbols_table, interner, object_file,
+                           line_number);
         
         /* Check operation field (which can be either an instruction or a directive) */
-        if (element_has_operation(&elements))
+        if (element_has_operation(elements))
         {
             /* Generate code for instruction */
-            instruction_size = evaluate_instruction(&elements,
-                                                    &instructions_table,
-                                                    section, line_number, &object_file,
-                                                    &write_list, &write_num);
+            instruction_ptr = evaluate_instruction(elements,
+                                                   section, line_number, object_file);
                   
-            if (instruction_size > 0) /* Detected as a instruction */
+            if (instruction_ptr) /* Detected as a instruction */
             {
                 is_instruction = 1;
         
                 /* Generate code for labels in operands */
-                if (element_has_operand1(&elements))
-                    evaluate_operand1(&elements,
-                                      instruction_size, &symbols_table, &object_file,
-                                      line_number);
+                if (element_has_operand1(elements))
+                    evaluate_operand1(elements,
+                                      instruction_ptr, symbols_table, interner,
+                                      object_file, constants, line_number);
                 
-                if (element_has_operand2(&elements))
-                    evaluate_operand2(&elements,
-                                      instruction_size, &symbols_table, &object_file,
-                                      line_number);
-                else if (instruction_size == 3) /* Doesn't have operand2 but requires it */
-                    error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%s\" "
-                                  "requires two arguments", elements.operation);
+                if (element_has_operand2(elements))
+                    evaluate_operand2(elements,
+                                      instruction_ptr, symbols_table, interner,
+                                      object_file, constants, line_number);
+                else if (instruction_ptr->size == 3) /* Requires operand2 */
+                    error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%.*s\" "
+                                  "requires two arguments", elements->operation.length,
+                                  elements->operation.ptr);
             }
             /* Generate code for directive */
             else
             {
-                is_directive = evaluate_directive(&elements,
-                                                  &directives_table, 
-                                                  &constants_table,
+                is_directive = evaluate_directive(elements,
+                                                  symbols_table,
+                                                  interner,
                                                   &section,
                                                   &is_data_section_defined,
                                                   &is_text_section_defined,
-                                                  line_number, &object_file);
+                                                  line_number, object_file,
+                                                  constants);
             }
         }   
         
         /* Check for invalid instructions or directives */
-        if ((element_has_operation(&elements)) && (!is_instruction) && (!is_directive))
-            error_at_line(ERROR_LEXICAL, line_number, "\"%s\" is not a valid instruction "
-                          "or directive", elements.operation);
+        if ((element_has_operation(elements)) && (!is_instruction) && (!is_directive))
+            error_at_line(ERROR_LEXICAL, line_number, "\"%.*s\" is not a valid instruction "
+                          "or directive", elements->operation.length,
+                          elements->operation.ptr);
         
-        element_clear(&elements); /* So as one line does not interfere to the other */
+        /* Record the line for the listing */
+        if (listing)
+        {
+            source_original_line(&preprocessor->source, &record.line, &original);
+            listing_add_line(listing, &original, address, object_file->size - address);
+            list_references(listing, elements, interner, is_instruction, line_number);
+        }
     }
     
+    /* Resolve references to labels defined after them */
+    resolve_fixups(symbols_table, interner, object_file, constants);
+    
     /* Check for errors */
-    check_undefined_labels(&symbols_table);
-    check_writing_at_const(&constants_table, &write_list, write_num);
+    check_undefined_labels(symbols_table, interner);
+    
+    if (object_file->data_section_address == -1)
+        error_at_line(ERROR_SYNTACTIC, 0, "Data section missing");
     
-    if (object_file.data_section_address == -1)
-        error(ERROR_SYNTACTIC, "Data section missing");
+    if (object_file->text_section_address == -1)
+        error_at_line(ERROR_SYNTACTIC, 0, "Text section missing");
     
-    if (object_file.text_section_address == -1)
-        error(ERROR_SYNTACTIC, "Text section missing");
+    /* Stop if errors were found while keeping going */
+    context_check_errors();
     
     /* Printing */
-    object_file_print(object_file);
+    if (is_printing)
+        object_file_print(object_file);
     
     /* Writing */
-    object_file_write(output, object_file);
+    export_symbols(symbols_table, interner, object_file);
+    
+    if (listing)
+        listing_write(listing, listing_file, object_file, symbols_table, interner);
+    
+    if (output)
+        object_file_close(object_file);
+    else
+        object_file_write_buffer(object_file, buffer, size);
     
     /* Finishing */
-    object_file_destroy(&object_file);
-    destroy_tables(&symbols_table, &instructions_table, &directives_table,
-                   &constants_table);
-    file_close(fp);
+    assembler_destroy(assembler);
+}
+
+/**
+ * Create the tables and object file of an assembly. An error cleanup is
+ * pushed for them, so they are released even if an error stops the assembly within an
+ * assembly context.
+ * @return pointer to the assembler struct, to be released with assembler_destroy.
+ */
+assembler_t* assembler_create(void)
+{
+    assembler_t *assembler = malloc(sizeof(assembler_t));
+    
+    if (!assembler)
+        error(ERROR_FILE, "Cannot allocate memory for assembling");
+    
+    init_tables(&assembler->symbols_table, &assembler->interner);
+    object_file_init(&assembler->object_file);
+    bitmap_init(&assembler->constants);
+    listing_init(&assembler->listing);
+    
+    context_push_cleanup(assembler_cleanup, assembler);
+    
+    return assembler;
+}
+
+/**
+ * Release everything created by assembler_create. An object file which was not closed is
+ * removed.
+ * @param assembler Pointer to an assembler struct.
+ */
+void assembler_destroy(assembler_t *assembler)
+{
+    context_pop_cleanup(assembler);
+    
+    object_file_abort(&assembler->object_file);
+    object_file_destroy(&assembler->object_file);
+    destroy_tables(&assembler->symbols_table, &assembler->interner);
+    bitmap_destroy(&assembler->constants);
+    listing_destroy(&assembler->listing);
+    free(assembler);
+}
+
+/**
+ * Error cleanup of an assembly.
+ * @param assembler Pointer to an assembler struct.
+ */
+void assembler_cleanup(void *assembler)
+{
+    assembler_destroy(assembler);
+}
+
+/**
+ * Record the labels a line refers to for the listing: the label it defines and, for an
+ * instruction, the labels of its operands. Operands of directives are not labels.
+ * @param listing Pointer to a listing struct.
+ * @param elements Elements of the line.
+ * @param interner Interner holding the label names.
+ * @param is_instruction Whether the operation of the line is an instruction.
+ * @param line_number Number of the line in the source file.
+ */
+void list_references(listing_t *listing, element_t *elements, interner_t *interner,
+                     int is_instruction, int line_number)
+{
+    span_t *operands[2];
+    int label_id;
+    int i;
+    
+    operands[0] = &elements->operand1;
+    operands[1] = &elements->operand2;
+    
+    if (element_has_label(elements) &&
+        ((label_id = interner_find(interner, elements->label.ptr,
+                                   elements->label.length)) != INTERNER_NOT_FOUND))
+        listing_add_reference(listing, label_id, line_number, 1);
+    
+    for (i = 0; is_instruction && (i < 2); ++i)
+    {
+        if (span_is_empty(operands[i]))
+            continue;
+        
+        label_id = interner_find(interner, operands[i]->ptr, operands[i]->name_length);
+        
+        if (label_id != INTERNER_NOT_FOUND)
+            listing_add_reference(listing, label_id, line_number, 0);
+    }
 }
 
 /**
- * Initialise all assembler tables.
+ * Export every defined label to the symbol table of the object file, in order of first
+ * appearance in the source code.
+ * @param symbols_table Table containing all symbols.
+ * @param interner Interner for the label names.
+ * @param object_file Output object file.
+ */
+void export_symbols(symbols_table_t *symbols_table, interner_t *interner,
+                    object_file_t *object_file)
+{
+    symbol_t *symbol_ptr;
+    int id;
+    
+    for (id = 0; id < interner_count(interner); ++id)
+    {
+        symbol_ptr = symbols_table_search(symbols_table, id);
+        
+        if (symbol_ptr && symbol_ptr->defined)
+            object_file_add_symbol(object_file, interner_string(interner, id),
+                                   symbol_ptr->value,
+                                   symbol_ptr->constant ? OBJECT_SYMBOL_CONSTANT : 0);
+    }
+}
+
+/**
+ * Initialise all assembler tables. The instructions and directives tables are constant
+ * and need no initialisation. Interned strings come from the arena of the assembly
+ * context, if it has one.
  * @param symbols_table Allocated table for storing labels.
- * @param instructions_table Allocated table for storing instructions.
- * @param directives_table Allocated table for storing directives.
- * @param constants_table Allocated table for storing constants.
+ * @param interner Allocated interner for the label names.
  */
-void init_tables(hash_table_t *symbols_table, hash_table_t *instructions_table,
-                 hash_table_t *directives_table, hash_table_t *constants_table)
+void init_tables(symbols_table_t *symbols_table, interner_t *interner)
 {
     symbols_table_init(symbols_table);
-    instructions_table_init(instructions_table);
-    directives_table_init(directives_table);
-    hash_create(constants_table, "Constants");
+    interner_init_in_arena(interner, context_arena());
 }
 
 /**
  * Destroy all assembler tables.
  * @param symbols_table Allocated table for storing labels.
- * @param instructions_table Allocated table for storing instructions.
- * @param directives_table Allocated table for storing directives.
- * @param constants_table Allocated table for storing constants.
+ * @param interner Allocated interner for the label names.
  */
-void destroy_tables(hash_table_t *symbols_table, hash_table_t *instructions_table,
-                    hash_table_t *directives_table, hash_table_t *constants_table)
+void destroy_tables(symbols_table_t *symbols_table, interner_t *interner)
 {
-    hash_destroy(symbols_table);
-    hash_destroy(instructions_table);
-    hash_destroy(directives_table);
-    hash_destroy(constants_table);
+    symbols_table_destroy(symbols_table);
+    interner_destroy(interner);
 }
 
 /**
  * Evaluate a given label, adding to the symbols table when not in the table yet. If it's
- * already in the table, it needs to update all previous references to the label by its
- * value. It deals with array accessing by updating the label value added by an offset.
- * Also, it analyses errors such as invalidity of its name, redefinitions and jumps to
- * the data section.
+ * already in the table, it is being defined after being referenced, and those references
+ * are kept as fixups until every label is defined.
+ * Also, it analyses errors such as invalidity of its name and redefinitions.
  * @param label Given label for evaluation.
  * @param symbols_table Tables containing all symbols defined so far.
+ * @param interner Interner for the label names.
  * @param object_file_ptr Pointer to the object file.
  * @param line_number Number of the current line in the source file.
  */
-void evaluate_label(element_t *elements, hash_table_t *symbols_table,
-                    object_file_t *object_file_ptr, int line_number)
+void evaluate_label(element_t *elements, symbols_table_t *symbols_table,
+                    interner_t *interner, object_file_t *object_file_ptr,
+                    int line_number)
 {
     symbol_t *symbol_ptr;
-    int previous_position;
-    int aux_position;
-    int offset;
-    char *label = elements->label;
+    span_t *label = &elements->label;
+    int label_id;
 
     /* Label analysis */
     if (!is_valid_label(label))
-        error_at_line(ERROR_LEXICAL, line_number, "\"%s\" is not a valid label name",
-                      label);
+        error_at_line(ERROR_LEXICAL, line_number, "\"%.*s\" is not a valid label name",
+                      label->length, label->ptr);
+    
+    label_id = interner_intern(interner, label->ptr, label->length);
     
     /* Label not in the table yet */
-    if (!(symbol_ptr = hash_search(symbols_table, label)))
+    if (!(symbol_ptr = symbols_table_search(symbols_table, label_id)))
     {
-        symbols_table_add(symbols_table, label, object_file_ptr->size, line_number);
-        symbol_ptr = hash_search(symbols_table, label);
-        symbol_ptr->defined = 1;
+        symbols_table_add(symbols_table, label_id, object_file_ptr->size, line_number);
+        symbols_table_define(symbols_table, label_id, object_file_ptr->size);
     }
     else
     {
         /* Label already in the table and defined */
         if (symbol_ptr->defined)
         {
-            error_at_line(ERROR_SEMANTIC, line_number, "Redefined label \"%s\"", label);
+            error_at_line(ERROR_SEMANTIC, line_number, "Redefined label \"%.*s\"",
+                          label->length, label->ptr);
         }
         /* Label already in the table but being defined now */
         else
         {
-            symbol_ptr->defined = 1;
-        
-            /*
-             * The current label value is the last position in memory it was used.
-             * This line must come before updating the value.
-             */
-            previous_position = symbol_ptr->value;
-            
             /*
              * Label value it the place in memory it is pointing, which is the next
              * position. That's why it is not necessary to subtract 1 from the current
              * object file size.
              */
-            symbol_ptr->value = object_file_ptr->size;
+            symbols_table_define(symbols_table, label_id, object_file_ptr->size);
+        }
+    }
+}
+
+/**
+ * Resolve every reference made to a label before its definition, once the whole source
+ * code was assembled. Fixups are grouped by symbol and swept in one pass: each reference
+ * gets the label value added by its offset for array accessing.
+ * Every section is known by then, so the section each label points to is found in the
+ * section map, for checking jumps to the data section and text memory addresses used as
+ * data. Writes are checked against the constant memory addresses now that their address
+ * is known. Fixups of undefined labels are left for check_undefined_labels.
+ * @param symbols_table Table containing all symbols.
+ * @param interner Interner for the label names.
+ * @param object_file Output object file.
+ * @param constants Bitmap of the constant memory addresses.
+ */
+void resolve_fixups(symbols_table_t *symbols_table, interner_t *interner,
+                    object_file_t *object_file, const bitmap_t *constants)
+{
+    section_map_t section_map;
+    section_t section;
+    symbol_t *symbol_ptr;
+    fixup_t *fixup_ptr;
+    int id;
+    int i;
+    
+    symbols_table_group_fixups(symbols_table);
+    section_map_init(&section_map, object_file);
+    
+    for (id = 0; id < interner_count(interner); ++id)
+    {
+        symbol_ptr = symbols_table_search(symbols_table, id);
+        
+        if (!symbol_ptr || !symbol_ptr->defined)
+            continue;
         
-            /* Replace previous definitions */
-            while (previous_position != -1)
+        section = section_map_find(&section_map, symbol_ptr->value);
+        
+        for (i = 0; i < symbol_ptr->fixup_count; ++i)
+        {
+            fixup_ptr = symbols_table_fixup(symbols_table, symbol_ptr->fixups + i);
+            
+            switch (fixup_ptr->opcode)
             {
-                /*
-                 * Check whether jumping to data section for previous calls to the label,
-                 * which happens when the instruction (available in the object file at the
-                 * previous position-1) is a jump. Also, it can only happen when the data
-                 * section is already defined, meaning that this label can be a constant
-                 * with its value pointing to the data section. Now, if the data section
-                 * is defined before the text section, the checking happen for values less
-                 * than the text section address. Otherwise, checking for values greater
-                 * than the data section are enough (meaning that the text section comes
-                 * before the data one).
-                 * The same reasoning applies to instructions that require a data memory
-                 * address, such as arithmetic operations and store/input.
-                 */
-                switch (object_file_get(*object_file_ptr, previous_position-1))
-                {
-                    case JMP_OPCODE:
-                    case JMPN_OPCODE:
-                    case JMPP_OPCODE:
-                    case JMPZ_OPCODE:
-                        if (object_file_ptr->data_section_address >
-                            object_file_ptr->text_section_address)
-                        {
-                            if ((object_file_ptr->data_section_address != -1) &&
-                                (symbol_ptr->value >= object_file_ptr->data_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Jumping to data section");
-                        }
-                        else
-                        {
-                            if ((object_file_ptr->data_section_address != -1) &&
-                                (symbol_ptr->value < object_file_ptr->text_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Jumping to data section");
-                        }
-                        break;
-                        
-                    case ADD_OPCODE:
-                    case SUB_OPCODE:
-                    case MULT_OPCODE:
-                    case STORE_OPCODE:
-                    case INPUT_OPCODE:
-                        if (object_file_ptr->data_section_address >
-                            object_file_ptr->text_section_address)
-                        {
-                            if ((object_file_ptr->text_section_address != -1) &&
-                                (symbol_ptr->value < object_file_ptr->data_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Using text memory address as data");
-                        }
-                        else
-                        {
-                            if ((object_file_ptr->text_section_address != -1) &&
-                                (symbol_ptr->value >= object_file_ptr->text_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Using text memory address as data");
-                        }
-                        break;
-                        
-                    case DIV_OPCODE:
-                        if (object_file_ptr->data_section_address >
-                            object_file_ptr->text_section_address)
-                        {
-                            if ((object_file_ptr->text_section_address != -1) &&
-                                (symbol_ptr->value < object_file_ptr->data_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Using text memory address as data");
-                        }
-                        else
-                        {
-                            if ((object_file_ptr->text_section_address != -1) &&
-                                (symbol_ptr->value >= object_file_ptr->text_section_address))
-                                error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                              "Using text memory address as data");
-                        }
-                        
-                        if (strcmp(elements->operand1, "0") == 0)
-                            error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
-                                          "Dividing by zero");
-                        
-                        break;
-                }
-                
-                /* Hold the next position in memory to go*/
-                aux_position = object_file_get(*object_file_ptr, previous_position);
-                
-                /* Get offset for array accessing */
-                offset = object_file_get_offset(*object_file_ptr, previous_position);
-                
-                /* Replace by adding the label value to the offset */
-                object_file_insert(object_file_ptr, previous_position,
-                                   symbol_ptr->value + offset);
-                
-                /* Go to the next position in memory */
-                previous_position = aux_position;
+                case JMP_OPCODE:
+                case JMPN_OPCODE:
+                case JMPP_OPCODE:
+                case JMPZ_OPCODE:
+                    if (section == SECTION_DATA)
+                        error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
+                                      "Jumping to data section");
+                    break;
+                    
+                case ADD_OPCODE:
+                case SUB_OPCODE:
+                case MULT_OPCODE:
+                case STORE_OPCODE:
+                case INPUT_OPCODE:
+                case DIV_OPCODE:
+                    if (section == SECTION_TEXT)
+                        error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
+                                      "Using text memory address as data");
+                    
+                    /* Checking division by a constant zero */
+                    if ((fixup_ptr->opcode == DIV_OPCODE) && symbol_ptr->constant &&
+                        (object_file_get(object_file, symbol_ptr->value) == 0))
+                        error_at_line(ERROR_SEMANTIC, symbol_ptr->line_number,
+                                      "Dividing by zero");
+                    break;
             }
+            
+            if (fixup_ptr->is_write)
+                check_writing_at_const(constants, interner, id,
+                                       symbol_ptr->value + fixup_ptr->offset,
+                                       fixup_ptr->line_number);
+            
+            /* Replace by adding the label value to the offset for array accessing */
+            object_file_insert(object_file, fixup_ptr->position,
+                               symbol_ptr->value + fixup_ptr->offset);
         }
     }
 }
 
+/**
+ * Build the map from memory addresses to sections. Each section is a contiguous range
+ * of addresses, starting at its address and ending where the next one starts, so the
+ * map only keeps the sections in address order.
+ * @param section_map Pointer to a section map struct.
+ * @param object_file Object file, with its sections already defined.
+ */
+void section_map_init(section_map_t *section_map, object_file_t *object_file)
+{
+    section_map->count = 0;
+    
+    if (object_file->data_section_address != -1)
+    {
+        section_map->addresses[section_map->count] = object_file->data_section_address;
+        section_map->sections[section_map->count++] = SECTION_DATA;
+    }
+    
+    if (object_file->text_section_address != -1)
+    {
+        section_map->addresses[section_map->count] = object_file->text_section_address;
+        section_map->sections[section_map->count++] = SECTION_TEXT;
+    }
+    
+    if ((section_map->count == 2) && (section_map->addresses[0] > section_map->addresses[1]))
+    {
+        section_map->addresses[0] = object_file->text_section_address;
+        section_map->sections[0] = SECTION_TEXT;
+        section_map->addresses[1] = object_file->data_section_address;
+        section_map->sections[1] = SECTION_DATA;
+    }
+}
+
+/**
+ * Find the section of a memory address. The last section extends past the end of the
+ * program, so labels defined at its very end belong to it.
+ * @param section_map Pointer to a section map struct.
+ * @param address Memory address.
+ * @return section of the address or SECTION_UNKNOWN if it comes before every section.
+ */
+section_t section_map_find(const section_map_t *section_map, int address)
+{
+    int i;
+    
+    for (i = section_map->count - 1; i >= 0; --i)
+        if (address >= section_map->addresses[i])
+            return section_map->sections[i];
+    
+    return SECTION_UNKNOWN;
+}
+
 /**
  * Check whether a instruction is valid and evaluate its opcode, writing it to the object
  * file.
- * It puts the target operand for instructions that write to the memory for later checking
- * if the code is writing to a constant memory address.
  * Errors can happen when an instruction is defined in the data section or when using a
  * division instruction with a constant 0.
- * @return The instruction size if it is a valid instruction, 0 otherwise.
+ * @return Pointer to the instruction if it is a valid instruction, NULL otherwise.
  */
-int evaluate_instruction(element_t *elements,
-                         hash_table_t *instructions_table, section_t section,
-                         int line_number, object_file_t *object_file, list_t *write_list,
-                         int *write_num)
+const instruction_t* evaluate_instruction(element_t *elements, section_t section,
+                                          int line_number, object_file_t *object_file)
 {
-    instruction_t *instruction_ptr;
-    char *instruction = elements->operation;
-    char *operand1 = elements->operand1;
-    char *operand2 = elements->operand2;
-    write_t *write_ptr;
+    const instruction_t *instruction_ptr;
+    span_t *instruction = &elements->operation;
 
     /* Only enters when the instruction is found in the instructions table */
-    if ((instruction_ptr = hash_search(instructions_table, instruction)))
+    if ((instruction_ptr = instructions_table_search(instruction->ptr, instruction->length)))
     {
         if (section == SECTION_DATA)
-            error_at_line(ERROR_SEMANTIC, line_number, "Using instruction \"%s\" in "
-                          "the data section", instruction);
+            error_at_line(ERROR_SEMANTIC, line_number, "Using instruction \"%.*s\" in "
+                          "the data section", instruction->length, instruction->ptr);
     
         /* Write opcode to the object file */
         object_file_add(object_file, instruction_ptr->opcode);
-        
-        /* For later checking whether writing in const memory */
-        if ((strcmp(instruction, "STORE") == 0) || (strcmp(instruction, "INPUT") == 0))
-        {
-            write_ptr = malloc(sizeof(write_t));
-            strcpy(write_ptr->label, operand1);
-            write_ptr->line_number = line_number;
-            list_append(write_list, write_ptr);
-        }
-        else if (strcmp(instruction, "COPY") == 0)
-        {
-            write_ptr = malloc(sizeof(write_t));
-            strcpy(write_ptr->label, operand2);
-            write_ptr->line_number = line_number;
-            list_append(write_list, write_ptr);
-        }
     
-        return instruction_ptr->size;
+        return instruction_ptr;
     }
     
-    return 0;
+    return NULL;
 }
 
 /**
  * Process an operand, returning its label name LABEL and offset value N when in the
- * notation LABEL[N].
+ * notation LABEL[N]. Both were already found by the scanner.
  * Also check for not valid operand label name.
- * @param output Allocated string for the processed label name.
- * @param label Input label.
+ * @param name Span for the processed label name, pointing into the operand.
+ * @param operand Input operand.
  * @param line_number Current line for error printing purposes.
  * @return The offset, which is zero if no offset was defined.
  */
-int process_operand(char *output, char *label, int line_number)
+int process_operand(span_t *name, const span_t *operand, int line_number)
 {
-    int i;
-    int label_size = strlen(label);
-    char num_str[strlen(label)];
-    int is_copying = 0;
-    int num_str_i = 0;
-    int offset;
-    
-    if (!is_valid_operand(label))
-        error_at_line(ERROR_LEXICAL, line_number, "\"%s\" is not a valid label name",
-                      label);
+    if (operand->kind == TOKEN_UNCLOSED)
+        error_at_line(ERROR_SYNTACTIC, line_number, "Missing closing ']' at label %.*s",
+                      operand->name_length, operand->ptr);
     
-    strcpy(output, label);
-    
-    for (i = 0; i < label_size; ++i)
-    {
-        /* Beginning of the offset, the output must end here */
-        if (label[i] == '[')
-        {
-            output[i] = '\0';
-            is_copying = 1;
-            continue;
-        }
-        
-        /* Copy the offset value for a string */
-        if (is_copying)
-        {
-            num_str[num_str_i] = label[i];
-            ++num_str_i;
-        }
-        
-        /* Finishing the offset string, convert to integer and return */
-        if (label[i] == ']')
-        {
-            offset = strtol(num_str, NULL, 0);
-            return offset;
-        }
-    }
+    if (!is_valid_operand(operand))
+        error_at_line(ERROR_LEXICAL, line_number, "\"%.*s\" is not a valid label name",
+                      operand->length, operand->ptr);
     
-    /* Only enters when no closure ']' was found */
-    if (is_copying)
-        error_at_line(ERROR_SYNTACTIC, line_number,
-                      "Missing closing ']' at label %s", output);
+    span_set(name, operand->ptr, operand->name_length, TOKEN_IDENTIFIER);
     
-    return 0; /* No offset was found */
+    return operand->value;
 }
 
 /**
@@ -480,32 +595,41 @@ int process_operand(char *output, char *label, int line_number)
  * instruction is a jump and the label value is pointing to the data section.
  * @param instruction Instruction string.
  * @param operand1 Operand string.
- * @param instruction_size Size of the instruction in words.
+ * @param instruction_ptr Instruction that receives the operand.
  * @param symbols_table Table that stores all labels.
+ * @param interner Interner for the label names.
  * @param object_file Output object file.
+ * @param constants Bitmap of the constant memory addresses, for checking writes.
  * @param line_number Current line for error printing purposes.
  */
-void evaluate_operand1(element_t *elements, int instruction_size,
-                       hash_table_t *symbols_table, object_file_t *object_file,
+void evaluate_operand1(element_t *elements, const instruction_t *instruction_ptr,
+                       symbols_table_t *symbols_table, interner_t *interner,
+                       object_file_t *object_file, const bitmap_t *constants,
                        int line_number)
 {
-    char processed_operand[100]; /* Operand without the offset when in LABEL[N] format */
+    span_t name; /* Operand without the offset when in LABEL[N] format */
     symbol_t *symbol_ptr; /* For searching the symbols table */
+    int operand_id;
     int offset;
-    char *instruction = elements->operation;
-    char *operand1 = elements->operand1;
+    span_t *instruction = &elements->operation;
+    int is_write = ((instruction_ptr->opcode == STORE_OPCODE) ||
+                    (instruction_ptr->opcode == INPUT_OPCODE));
     
-    if (instruction_size == 1)
-        error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%s\" does "
-                      "not accept arguments", instruction);
+    if (instruction_ptr->size == 1)
+        error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%.*s\" does "
+                      "not accept arguments", instruction->length, instruction->ptr);
     
-    offset = process_operand(processed_operand, operand1, line_number);
+    offset = process_operand(&name, &elements->operand1, line_number);
+    operand_id = interner_intern(interner, name.ptr, name.length);
+    object_file_add_relocation(object_file, object_file->size);
     
     /* Not in the symbols table, add it and its offset */
-    if (!(symbol_ptr = hash_search(symbols_table, processed_operand)))
+    if (!(symbol_ptr = symbols_table_search(symbols_table, operand_id)))
     {
-        symbols_table_add(symbols_table, processed_operand, object_file->size, line_number);
-        object_file_add_with_offset(object_file, -1, offset);
+        symbols_table_add(symbols_table, operand_id, 0, line_number);
+        symbols_table_add_fixup(symbols_table, operand_id, object_file->size, offset,
+                                instruction_ptr->opcode, line_number, is_write);
+        object_file_add(object_file, 0);
     }
     else
     {
@@ -519,94 +643,114 @@ void evaluate_operand1(element_t *elements, int instruction_size,
              * This will only happen to operands if the data section comes before the text
              * section.
              */
-            if ((strcmp(instruction, "JMP") == 0) ||
-                (strcmp(instruction, "JMPN") == 0) ||
-                (strcmp(instruction, "JMPP") == 0) ||
-                (strcmp(instruction, "JMPZ") == 0))
-            {
-                if ((object_file->text_section_address != -1) &&
-                    (symbol_ptr->value < object_file->text_section_address))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Jumping to data section");
-            }
-            else if ((strcmp(instruction, "ADD") == 0) ||
-                     (strcmp(instruction, "SUB") == 0) ||
-                     (strcmp(instruction, "MULT") == 0) ||
-                     (strcmp(instruction, "STORE") == 0) ||
-                     (strcmp(instruction, "INPUT") == 0))
+            switch (instruction_ptr->opcode)
             {
-                if ((object_file->text_section_address != -1) &&
-                    (symbol_ptr->value > object_file->text_section_address))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Using text memory address "
-                                  "as data");
-            }
-            else if (strcmp(instruction, "DIV") == 0)
-            {
-                if ((object_file->text_section_address != -1) &&
-                    (symbol_ptr->value > object_file->text_section_address))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Using text memory address "
-                                  "as data");
-                                  
-                /* Checking division by zero */
-                if ((object_file->data_section_address != -1) &&
-                     (object_file_get(*object_file, symbol_ptr->value) == 0))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Division by zero");
+                case JMP_OPCODE:
+                case JMPN_OPCODE:
+                case JMPP_OPCODE:
+                case JMPZ_OPCODE:
+                    if ((object_file->text_section_address != -1) &&
+                        (symbol_ptr->value < object_file->text_section_address))
+                        error_at_line(ERROR_SEMANTIC, line_number,
+                                      "Jumping to data section");
+                    break;
+                    
+                case ADD_OPCODE:
+                case SUB_OPCODE:
+                case MULT_OPCODE:
+                case STORE_OPCODE:
+                case INPUT_OPCODE:
+                    if ((object_file->text_section_address != -1) &&
+                        (symbol_ptr->value > object_file->text_section_address))
+                        error_at_line(ERROR_SEMANTIC, line_number, "Using text memory "
+                                      "address as data");
+                    break;
+                    
+                case DIV_OPCODE:
+                    if ((object_file->text_section_address != -1) &&
+                        (symbol_ptr->value > object_file->text_section_address))
+                        error_at_line(ERROR_SEMANTIC, line_number, "Using text memory "
+                                      "address as data");
+                    
+                    /* Checking division by zero */
+                    if ((object_file->data_section_address != -1) &&
+                         (object_file_get(object_file, symbol_ptr->value) == 0))
+                        error_at_line(ERROR_SEMANTIC, line_number, "Division by zero");
+                    break;
+                    
+                default:
+                    break;
             }
             
+            if (is_write)
+                check_writing_at_const(constants, interner, operand_id,
+                                       symbol_ptr->value + offset, line_number);
+            
             object_file_add(object_file, symbol_ptr->value + offset);
         }
         /*
-         * Already in the symbols table but not defined, point to the location of the
-         * label last call (stored as the symbol value in the symbols table) and its
-         * offset.
+         * Already in the symbols table but not defined, add another reference to be
+         * fixed when the label is defined.
          */
         else
         {
-            object_file_add_with_offset(object_file, symbol_ptr->value, offset);
-            symbol_ptr->value = object_file->size - 1;
+            symbols_table_add_fixup(symbols_table, operand_id, object_file->size, offset,
+                                    instruction_ptr->opcode, line_number, is_write);
+            object_file_add(object_file, 0);
         }
     }
 }
 
-void evaluate_operand2(element_t *elements, int instruction_size,
-                       hash_table_t *symbols_table, object_file_t *object_file,
+void evaluate_operand2(element_t *elements, const instruction_t *instruction_ptr,
+                       symbols_table_t *symbols_table, interner_t *interner,
+                       object_file_t *object_file, const bitmap_t *constants,
                        int line_number)
 {
-    char processed_operand[100];
+    span_t name;
     symbol_t *symbol_ptr;
+    int operand_id;
     int offset;
-    char *instruction = elements->operation;
-    char *operand2 = elements->operand2;
+    span_t *instruction = &elements->operation;
     
-    if (instruction_size == 2)
-        error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%s\" only "
-                      "accepts one argument", instruction);
+    if (instruction_ptr->size == 2)
+        error_at_line(ERROR_SYNTACTIC, line_number, "Instruction \"%.*s\" only "
+                      "accepts one argument", instruction->length, instruction->ptr);
     
     /* Label accessing array memory using the format LABEL[x] */
-    offset = process_operand(processed_operand, operand2, line_number);
+    offset = process_operand(&name, &elements->operand2, line_number);
+    operand_id = interner_intern(interner, name.ptr, name.length);
+    object_file_add_relocation(object_file, object_file->size);
     
-    if (!(symbol_ptr = hash_search(symbols_table, processed_operand)))
+    if (!(symbol_ptr = symbols_table_search(symbols_table, operand_id)))
     {
-        symbols_table_add(symbols_table, processed_operand, object_file->size, line_number);
-        object_file_add_with_offset(object_file, -1, offset);
+        symbols_table_add(symbols_table, operand_id, 0, line_number);
+        symbols_table_add_fixup(symbols_table, operand_id, object_file->size, offset,
+                                instruction_ptr->opcode, line_number, 1);
+        object_file_add(object_file, 0);
     }
     else
     {
         if (symbol_ptr->defined)
         {
-            if (strcmp(instruction, "COPY") == 0)
+            if (instruction_ptr->opcode == COPY_OPCODE)
             {
                 if ((object_file->text_section_address != -1) &&
                     (symbol_ptr->value > object_file->text_section_address))
                     error_at_line(ERROR_SEMANTIC, line_number, "Using text memory address "
                                   "as data");
             }
+            
+            /* The second operand of COPY is always written to */
+            check_writing_at_const(constants, interner, operand_id,
+                                   symbol_ptr->value + offset, line_number);
         
-            object_file_add(object_file, symbol_ptr->value);
+            object_file_add(object_file, symbol_ptr->value + offset);
         }
         else
         {
-            object_file_add_with_offset(object_file, symbol_ptr->value, offset);
-            symbol_ptr->value = object_file->size - 1;
+            symbols_table_add_fixup(symbols_table, operand_id, object_file->size, offset,
+                                    instruction_ptr->opcode, line_number, 1);
+            object_file_add(object_file, 0);
         }
     }
 }
@@ -617,27 +761,25 @@ void evaluate_operand2(element_t *elements, int instruction_size,
  * directive) or by invalid use of the directive (wrong number of arguments or section
  * name).
  */
-int evaluate_directive(element_t *elements,
-                       hash_table_t *directives_table, hash_table_t *constants_table,
-                       section_t *section, int *is_data_section_defined,
-                       int *is_text_section_defined, int line_number,
-                       object_file_t *object_file)
+int evaluate_directive(element_t *elements, symbols_table_t *symbols_table,
+                       interner_t *interner, section_t *section,
+                       int *is_data_section_defined, int *is_text_section_defined,
+                       int line_number, object_file_t *object_file,
+                       bitmap_t *constants)
 {
-    directive_t *directive_ptr;
-    const_t *constant;
+    symbol_t *symbol_ptr;
     int space_num;
-    int i;
-    char *directive = elements->operation;
+    span_t *directive = &elements->operation;
+    span_t *operand1 = &elements->operand1;
     
     /* Generate code for directive */
-    if ((directive_ptr = hash_search(directives_table, directive)))
+    switch (directives_table_search(directive->ptr, directive->length))
     {
-        if (strcmp(directive, "CONST") == 0)
-        {
+        case DIRECTIVE_CONST:
             /* Error checking */
             if ((*section) == SECTION_TEXT)
-                error_at_line(ERROR_SEMANTIC, line_number, "Using directive \"%s\" "
-                              "in the text section", directive);
+                error_at_line(ERROR_SEMANTIC, line_number, "Using directive \"%.*s\" "
+                              "in the text section", directive->length, directive->ptr);
             
             if (element_has_operand2(elements))
                 error_at_line(ERROR_SYNTACTIC, line_number, "CONST directive accepts "
@@ -647,44 +789,52 @@ int evaluate_directive(element_t *elements,
                 error_at_line(ERROR_SYNTACTIC, line_number, "CONST directive requires "
                               "one argument");
         
-            /* Add the constant to the object file and insert to the constant table */
-            object_file_add(object_file, strtol(elements->operand1, NULL, 0));
-            constant = malloc(sizeof(const_t));
-            hash_insert(constants_table, elements->label, constant);
-        }
-        else if (strcmp(directive, "SPACE") == 0)
-        {
+            /* Add the constant to the object file and flag its address and label */
+            bitmap_set(constants, object_file->size);
+            object_file_add(object_file, operand1->value);
+            
+            if (element_has_label(elements))
+            {
+                symbol_ptr = symbols_table_search(symbols_table,
+                                                  interner_find(interner,
+                                                                elements->label.ptr,
+                                                                elements->label.length));
+                if (symbol_ptr)
+                    symbol_ptr->constant = 1;
+            }
+            return 1;
+            
+        case DIRECTIVE_SPACE:
             if ((*section) == SECTION_TEXT)
-                error_at_line(ERROR_SEMANTIC, line_number, "Using directive \"%s\" "
-                              "in the text section", directive);
+                error_at_line(ERROR_SEMANTIC, line_number, "Using directive \"%.*s\" "
+                              "in the text section", directive->length, directive->ptr);
             
             /* Reserve one space by default or the number defined with the parameter */
             if (element_has_operand1(elements))
-                space_num = strtol(elements->operand1, NULL, 0);
+                space_num = operand1->value;
             else
                 space_num = 1;
             
             /* Initializing SPACE with zero value */
-            for (i = 0; i < space_num; ++i)
-                object_file_add(object_file, 0);
-        }
-        else if (strcmp(directive, "SECTION") == 0)
-        {
-            if (strcmp(elements->operand1, "DATA") == 0)
+            object_file_add_zeroes(object_file, space_num);
+            return 1;
+            
+        case DIRECTIVE_SECTION:
+            if (span_equals(operand1, "DATA"))
             {
                 if ((*is_data_section_defined) && (*is_text_section_defined))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Section \"%s\" is "
-                                  "already defined", elements->operand1);
+                    error_at_line(ERROR_SEMANTIC, line_number, "Section \"%.*s\" is "
+                                  "already defined", operand1->length, operand1->ptr);
                 
                 *is_data_section_defined = object_file->size;
                 object_file->data_section_address = object_file->size;
                 *section = SECTION_DATA;
             }
-            else if (strcmp(elements->operand1, "TEXT") == 0)
+            else if (span_equals(operand1, "TEXT"))
             {
                 if ((*is_data_section_defined) && (*is_text_section_defined))
-                    error_at_line(ERROR_SEMANTIC, line_number, "Section \"%s\" is "
-                                  "already defined", elements->operand1);
+                    error_at_line(ERROR_SEMANTIC, line_number, "Section \"%.*s\" is "
+                                  "already defined", operand1->length, operand1->ptr);
                 
                 *is_text_section_defined = object_file->size;
                 object_file->text_section_address = object_file->size;
@@ -693,63 +843,57 @@ int evaluate_directive(element_t *elements,
             else
             {
                 error_at_line(ERROR_SYNTACTIC, line_number, "Unknown section directive "
-                              "\"%s\"", elements->operand1);
+                              "\"%.*s\"", operand1->length, operand1->ptr);
             }
             
             if (element_has_operand2(elements))
                 error_at_line(ERROR_SYNTACTIC, line_number, "SECTION directive accepts "
                               "only one argument");
-        }
-        
-        return 1;
+            return 1;
+            
+        default:
+            return 0;
     }
-    
-    return 0;
 }
 
 /**
- * Check whether any label was left undefined in the symbols table.
+ * Check whether any label was left undefined in the symbols table. Only the list of
+ * undefined labels is walked, in order of first appearance, so every one of them is
+ * reported when errors do not stop the assembly.
  * @param symbols_table Allocated table containing all labels.
+ * @param interner Interner holding the label names.
  */
-void check_undefined_labels(hash_table_t *symbols_table)
+void check_undefined_labels(symbols_table_t *symbols_table, interner_t *interner)
 {
-    hash_list_node_t *hash_list_node_ptr;
-    char *label_ptr;
+    int label_id;
     int line_number;
     
-    if ((hash_list_node_ptr = symbols_table_has_undefined(symbols_table)))
+    if (symbols_table->undefined_count == 0)
+        return;
+    
+    for (label_id = symbols_table_has_undefined(symbols_table);
+         label_id != SYMBOLS_TABLE_NO_SYMBOL;
+         label_id = symbols_table_next_undefined(symbols_table, label_id))
     {
-        label_ptr = hash_list_node_ptr->key;
-        line_number = ((symbol_t*)hash_list_node_ptr->data)->line_number;
-        error_at_line(ERROR_SEMANTIC, line_number, "Undefined label \"%s\"", label_ptr);
+        line_number = symbols_table_search(symbols_table, label_id)->line_number;
+        error_at_line(ERROR_SEMANTIC, line_number, "Undefined label \"%s\"",
+                      interner_string(interner, label_id));
     }
 }
 
 /**
- * Check all labels in the write list and search it in the constant table. If any is found,
- * it means an instruction is attempting to write to a constant memory address and an error
- * should be raised.
- * @param constants_table Allocated table storing all program constants.
- * @param write_list List of labels used as targets by writing instructions.
- * @param write_num Number of elements in the write_list.
+ * Check whether an instruction writes to a constant memory address, which is flagged in
+ * the constants bitmap by the CONST directive, raising an error if so.
+ * @param constants Bitmap of the constant memory addresses.
+ * @param interner Interner holding the label names.
+ * @param label_id Interned id of the label written to.
+ * @param address Memory address written to.
+ * @param line_number Line of the writing instruction.
  */
-void check_writing_at_const(hash_table_t *constants_table, list_t *write_list,
-                            int write_num)
+void check_writing_at_const(const bitmap_t *constants, interner_t *interner, int label_id,
+                            int address, int line_number)
 {
-    const_t *constant;
-    char *label;
-    list_node_t *current_node = write_list->head;
-    
-    while (current_node != NULL)
-    {
-        label = ((write_t*)current_node->data)->label;
-        
-        if ((constant = hash_search(constants_table, label)))
-        {
-            error_at_line(ERROR_SEMANTIC, ((write_t*)current_node->data)->line_number, "Cannot write to the "
-                          "constant label %s", label);
-        }
-        
-        current_node = current_node->next;
-    }
-}
\ No newline at end of file
+    if (bitmap_test(constants, address))
+        error_at_line(ERROR_SEMANTIC, line_number, "Cannot write to the constant label %s",
+                      interner_string(interner, label_id));
+}
@@ -39,21 +39,27 @@
  * CONST (NUM): Write NUM to the memory in the address occupied by the directive
  */
 
+#ifndef _ASSEMBLER_H_
+#define _ASSEMBLER_H_
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
 #include "file.h"
+#include "source.h"
 #include "object_file.h"
 #include "elements.h"
 #include "scanner.h"
 #include "directives_table.h"
 #include "instructions_table.h"
+#include "interner.h"
 #include "symbols_table.h"
-#include "linked_list.h"
-#include "hash_table.h"
+#include "bitmap.h"
+#include "listing.h"
 #include "preprocessor.h"
+#include "context.h"
 
 /**
  * All possible program sections
@@ -65,45 +71,76 @@ typedef enum
     SECTION_TEXT,
 } section_t;
 
-/**
- * Used for checking if writing to a constant memory address. Includes the line number for
- * error printing purposes.
+/*
+ * A section map struct finds the section of a memory address. It contains the following
+ * fields:
+ * - addresses: Start address of each defined section, in increasing order.
+ * - sections: Section starting at each address.
+ * - count: Number of defined sections.
  */
 typedef struct
 {
-    char label[100];
-    int line_number;
-} write_t;
+    int addresses[2];
+    section_t sections[2];
+    int count;
+} section_map_t;
 
-/**
- * Boilerplate for constant table
+/*
+ * An assembler struct holds everything an assembly allocates:
+ * - symbols_table: Every used symbol, indexed by label id.
+ * - interner: Interner for the label names.
+ * - object_file: Output object file.
+ * - constants: Bitmap of the constant memory addresses, for checking writes to them.
+ * - listing: Lines and label references recorded for the listing, when it is written.
  */
 typedef struct
 {
-} const_t;
+    symbols_table_t symbols_table;
+    interner_t interner;
+    object_file_t object_file;
+    bitmap_t constants;
+    listing_t listing;
+} assembler_t;
 
-void assemble(char *input, char *output);
-void init_tables(hash_table_t *symbols_table, hash_table_t *instructions_table,
-                 hash_table_t *directives_table, hash_table_t *constants_table);
-void destroy_tables(hash_table_t *symbols_table, hash_table_t *instructions_table,
-                    hash_table_t *directives_table, hash_table_t *constants_table);
-void evaluate_label(element_t *elements, hash_table_t *symbols_table,
-                    object_file_t *object_file_ptr, int line_number);
-int evaluate_instruction(element_t *elements,
-                         hash_table_t *instructions_table, section_t section,
-                         int line_number, object_file_t *object_file, list_t *write_list,
-                         int *write_num);
-int process_operand(char *output, char *label, int line_number);
-void evaluate_operand1(element_t *elements, int instruction_size,
-                       hash_table_t *symbols_table, object_file_t *object_file,
+void assemble(preprocessor_t *preprocessor, char *output, char *listing_file);
+void assemble_to_buffer(preprocessor_t *preprocessor, unsigned char **buffer,
+                        size_t *size);
+void assemble_object(preprocessor_t *preprocessor, char *output, char *listing_file,
+                     unsigned char **buffer, size_t *size);
+assembler_t* assembler_create(void);
+void assembler_destroy(assembler_t *assembler);
+void assembler_cleanup(void *assembler);
+void init_tables(symbols_table_t *symbols_table, interner_t *interner);
+void destroy_tables(symbols_table_t *symbols_table, interner_t *interner);
+void evaluate_label(element_t *elements, symbols_table_t *symbols_table,
+                    interner_t *interner, object_file_t *object_file_ptr,
+                    int line_number);
+void resolve_fixups(symbols_table_t *symbols_table, interner_t *interner,
+                    object_file_t *object_file, const bitmap_t *constants);
+void section_map_init(section_map_t *section_map, object_file_t *object_file);
+section_t section_map_find(const section_map_t *section_map, int address);
+const instruction_t* evaluate_instruction(element_t *elements, section_t section,
+                                          int line_number, object_file_t *object_file);
+int process_operand(span_t *name, const span_t *operand, int line_number);
+void evaluate_operand1(element_t *elements, const instruction_t *instruction_ptr,
+                       symbols_table_t *symbols_table, interner_t *interner,
+                       object_file_t *object_file, const bitmap_t *constants,
                        int line_number);
-void evaluate_operand2(element_t *elements, int instruction_size,
-                       hash_table_t *symbols_table, object_file_t *object_file,
+void evaluate_operand2(element_t *elements, const instruction_t *instruction_ptr,
+                       symbols_table_t *symbols_table, interner_t *interner,
+                       object_file_t *object_file, const bitmap_t *constants,
                        int line_number);
-int evaluate_directive(element_t *elements,
-                       hash_table_t *directives_table, hash_table_t *constants_table,
-                       section_t *section, int *is_data_section_defined,
-                       int *is_text_section_defined, int line_number,
-                       object_file_t *object_file);
-void check_undefined_labels(hash_table_t *symbols_table);
-void check_writing_at_const(hash_table_t *constants_table, list_t *write_list, int write_num);
\ No newline at end of file
+int evaluate_directive(element_t *elements, symbols_table_t *symbols_table,
+                       interner_t *interner, section_t *section,
+                       int *is_data_section_defined, int *is_text_section_defined,
+                       int line_number, object_file_t *object_file,
+                       bitmap_t *constants);
+void list_references(listing_t *listing, element_t *elements, interner_t *interner,
+                     int is_instruction, int line_number);
+void export_symbols(symbols_table_t *symbols_table, interner_t *interner,
+                    object_file_t *object_file);
+void check_undefined_labels(symbols_table_t *symbols_table, interner_t *interner);
+void check_writing_at_const(const bitmap_t *constants, interner_t *interner, int label_id,
+                            int address, int line_number);
+
+#endif /* _ASSEMBLER_H_ */
\ No newline at end of file
@@ -0,0 +1,322 @@
+/**
+ * @file   batch.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements batch assembly
+ *
+ * Each file is assembled with its progress discarded and its error messages written to a
+ * memory stream. The preprocessor and the context of each file are allocated, instead of
+ * being local variables of the function which calls setjmp, so they keep their values
+ * after an error jumps back.
+ */
+
+#include "batch.h"
+
+/**
+ * Init an empty batch.
+ * @param batch Pointer to a batch struct.
+ */
+void batch_init(batch_t *batch)
+{
+    batch->files = malloc(sizeof(batch_file_t)*BATCH_INITIAL_CAPACITY);
+    batch->count = 0;
+    batch->capacity = BATCH_INITIAL_CAPACITY;
+    batch->manifest.data = NULL;
+    batch->max_errors = 0;
+    batch->cache = NULL;
+    batch->arenas = NULL;
+    
+    if (!batch->files)
+        error(ERROR_COMMAND_LINE, "Cannot allocate memory for batch");
+}
+
+/**
+ * Free all memory used by a batch.
+ * @param batch Pointer to a batch struct.
+ */
+void batch_destroy(batch_t *batch)
+{
+    int i;
+    
+    for (i = 0; i < batch->count; ++i)
+    {
+        free(batch->files[i].output);
+        free(batch->files[i].diagnostics);
+    }
+    
+    free(batch->files);
+    source_close(&batch->manifest);
+}
+
+/**
+ * Add a source file to a batch.
+ * @param batch Pointer to a batch struct.
+ * @param input Source file name, which must be valid until the batch is destroyed.
+ */
+void batch_add(batch_t *batch, char *input)
+{
+    batch_file_t *file;
+    
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity *= 2;
+        batch->files = realloc(batch->files, sizeof(batch_file_t)*batch->capacity);
+        
+        if (!batch->files)
+            error(ERROR_COMMAND_LINE, "Cannot allocate memory for batch");
+    }
+    
+    file = &batch->files[batch->count++];
+    file->input = input;
+    file->output = batch_output_name(input);
+    file->status = 0;
+    file->diagnostics = NULL;
+    file->diagnostics_size = 0;
+    file->is_cached = 0;
+}
+
+/**
+ * Add the source files listed in a manifest to a batch. The manifest has one file name per
+ * line. Blank lines are skipped, and so are trailing spaces.
+ * @param batch Pointer to a batch struct.
+ * @param filename Manifest file name.
+ */
+void batch_add_manifest(batch_t *batch, char *filename)
+{
+    source_line_t line;
+    
+    if (batch->manifest.data)
+        error(ERROR_COMMAND_LINE, "Only one manifest may be given");
+    
+    source_open(&batch->manifest, filename);
+    
+    while (source_next_line(&batch->manifest, &line))
+    {
+        while ((line.length > 0) && ((line.ptr[line.length - 1] == ' ') ||
+                                     (line.ptr[line.length - 1] == '\t') ||
+                                     (line.ptr[line.length - 1] == '\r')))
+            --line.length;
+        
+        if (line.length == 0)
+            continue;
+        
+        /* Replace the '\n' or a trailing space, so the name is null-terminated in place */
+        line.ptr[line.length] = '\0';
+        batch_add(batch, line.ptr);
+    }
+}
+
+/**
+ * Get the object file name of a source file, replacing its extension, if any, with
+ * BATCH_OUTPUT_EXTENSION.
+ * @param input Source file name.
+ * @return object file name, which must be freed.
+ */
+char* batch_output_name(const char *input)
+{
+    const char *slash = strrchr(input, '/');
+    const char *dot = strrchr(input, '.');
+    size_t length = strlen(input);
+    char *output;
+    
+    if (dot && (!slash || (dot > slash + 1)))
+        length = dot - input;
+    
+    output = malloc(length + strlen(BATCH_OUTPUT_EXTENSION) + 1);
+    
+    if (!output)
+        error(ERROR_COMMAND_LINE, "Cannot allocate memory for batch");
+    
+    memcpy(output, input, length);
+    strcpy(output + length, BATCH_OUTPUT_EXTENSION);
+    
+    return output;
+}
+
+/**
+ * Assemble every file of a batch. Each worker gets its own arena, released once every
+ * file is done. The cache, if any, is only trimmed to its size limit then too.
+ * @param batch Pointer to a batch struct.
+ * @param jobs Number of files assembled at once.
+ */
+void batch_run(batch_t *batch, int jobs)
+{
+    int i;
+    
+    if (jobs < 1)
+        jobs = 1;
+    
+    if (!(batch->arenas = malloc(sizeof(arena_t)*jobs)))
+        error(ERROR_COMMAND_LINE, "Cannot allocate memory for batch");
+    
+    for (i = 0; i < jobs; ++i)
+        arena_init(&batch->arenas[i]);
+    
+    pool_run(batch->count, jobs, batch_assemble_file, batch);
+    
+    for (i = 0; i < jobs; ++i)
+        arena_destroy(&batch->arenas[i]);
+    
+    free(batch->arenas);
+    batch->arenas = NULL;
+    
+    if (batch->cache)
+        cache_evict(batch->cache);
+}
+
+/**
+ * Assemble a file of a batch, unless its object file is in the cache. A file assembled
+ * without errors is added to the cache. Runs on a thread of the pool.
+ * @param index Index of the file.
+ * @param worker Index of the worker, whose arena the assembly uses.
+ * @param arg Pointer to the batch struct.
+ */
+void batch_assemble_file(int index, int worker, void *arg)
+{
+    batch_t *batch = arg;
+    batch_file_t *file = &batch->files[index];
+    char key[CACHE_KEY_SIZE + 1];
+    char *outputs[CACHE_KIND_COUNT];
+    int is_keyed = batch->cache && (cache_key(file->input, key) == CACHE_OK);
+    
+    outputs[CACHE_OBJECT] = file->output;
+    outputs[CACHE_PREPROCESSED] = NULL;
+    outputs[CACHE_LISTING] = NULL;
+    
+    if (is_keyed && (cache_fetch(batch->cache, key, outputs) == CACHE_OK))
+    {
+        file->is_cached = 1;
+        return;
+    }
+    
+    batch_assemble_source(batch, file, &batch->arenas[worker]);
+    
+    if (is_keyed && (file->status == 0))
+        cache_store(batch->cache, key, outputs);
+}
+
+/**
+ * Assemble a file of a batch within its own assembly context, keeping its error messages
+ * and exit status. When the batch keeps going after errors, they are collected and
+ * written sorted once the assembly is over. The interned strings of the assembly come from
+ * the arena, which is reset once the assembly is over, even after an error.
+ * @param batch Pointer to a batch struct.
+ * @param file File of the batch.
+ * @param arena Arena lent to the assembly, which nothing else uses meanwhile.
+ */
+void batch_assemble_source(batch_t *batch, batch_file_t *file, arena_t *arena)
+{
+    context_t *context = malloc(sizeof(context_t));
+    preprocessor_t *preprocessor = malloc(sizeof(preprocessor_t));
+    diagnostics_t *diagnostics = NULL;
+    FILE *err = open_memstream(&file->diagnostics, &file->diagnostics_size);
+    
+    if (batch->max_errors && (diagnostics = malloc(sizeof(diagnostics_t))) &&
+        !diagnostics_init(diagnostics, batch->max_errors))
+    {
+        free(diagnostics);
+        diagnostics = NULL;
+    }
+    
+    if (!context || !preprocessor || !err || (batch->max_errors && !diagnostics))
+    {
+        file->status = ERROR_FILE;
+        free(context);
+        free(preprocessor);
+        
+        if (diagnostics)
+            diagnostics_destroy(diagnostics);
+        
+        free(diagnostics);
+        
+        if (err)
+            fclose(err);
+        
+        return;
+    }
+    
+    context_init(context, NULL, err);
+    context->arena = arena;
+    
+    if (diagnostics)
+    {
+        context->report = diagnostics_report;
+        context->report_arg = diagnostics;
+    }
+    
+    context_enter(context);
+    
+    if (setjmp(context->jump) == 0)
+    {
+        preprocess(preprocessor, file->input, NULL, 0, 0);
+        assemble(preprocessor, file->output, NULL);
+        preprocessor_destroy(preprocessor);
+    }
+    
+    context_cleanup(context);
+    context_leave();
+    arena_reset(arena);
+    
+    if (diagnostics)
+    {
+        diagnostics_print(diagnostics, err);
+        diagnostics_destroy(diagnostics);
+        free(diagnostics);
+    }
+    
+    file->status = context->status;
+    fclose(err);
+    free(preprocessor);
+    free(context);
+}
+
+/**
+ * Report the exit status of each file of a batch, in order, on stdout. The error messages
+ * of each file go to stderr, each line prefixed by the file name.
+ * @param batch Pointer to a batch struct, after running it.
+ * @return exit status of the first file which failed, or 0 if every file was assembled.
+ */
+int batch_report(batch_t *batch)
+{
+    batch_file_t *file;
+    char *line;
+    char *end;
+    char *newline;
+    int status = 0;
+    int failed = 0;
+    int i;
+    
+    for (i = 0; i < batch->count; ++i)
+    {
+        file = &batch->files[i];
+        line = file->diagnostics;
+        end = file->diagnostics + file->diagnostics_size;
+        
+        for (; line && (line < end); line = newline + 1)
+        {
+            if (!(newline = memchr(line, '\n', end - line)))
+                newline = end;
+            
+            fprintf(stderr, "%s: %.*s\n", file->input, (int)(newline - line), line);
+        }
+        
+        if (file->status == 0)
+        {
+            printf("%s -> %s: OK%s\n", file->input, file->output,
+                   file->is_cached ? " (cached)" : "");
+            continue;
+        }
+        
+        printf("%s: exit status %d (", file->input, file->status);
+        print_error_type(stdout, file->status);
+        printf(")\n");
+        
+        if (!failed++)
+            status = file->status;
+    }
+    
+    printf("\n%d of %d files assembled\n", batch->count - failed, batch->count);
+    
+    return status;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file   batch.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares batch assembly
+ *
+ * A batch assembles many source files in one process, several at once, on a thread pool.
+ * The object file of each source gets its name, with the extension replaced by ".obj".
+ * Each file is assembled within its own assembly context, so an error only stops that
+ * file, and its messages are kept apart to be reported with its exit status once every
+ * file is done. The instructions and directives tables are constant, so all threads share
+ * them. Each worker lends the files it assembles an arena for their interned strings,
+ * which is reset after each file, so its blocks serve the next one. With a cache, files
+ * which did not change since they were last assembled get their object file from the
+ * cache instead.
+ *
+ * Example usage
+ *
+    batch_t batch;
+    int status;
+    
+    batch_init(&batch);
+    batch_add(&batch, "first.asm");
+    batch_add(&batch, "second.asm");
+    batch_run(&batch, 2);
+    status = batch_report(&batch);
+    batch_destroy(&batch);
+ */
+
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "error.h"
+#include "context.h"
+#include "diagnostics.h"
+#include "source.h"
+#include "preprocessor.h"
+#include "assembler.h"
+#include "pool.h"
+#include "cache.h"
+
+/* Initial capacity of the files array */
+#define BATCH_INITIAL_CAPACITY 16
+
+/* Extension of the object files */
+#define BATCH_OUTPUT_EXTENSION ".obj"
+
+/*
+ * A batch file struct contains the following fields:
+ * - input: Source file name.
+ * - output: Object file name.
+ * - status: Exit status of its assembly, which is 0 on success or the error type.
+ * - diagnostics: Error messages of its assembly, or NULL.
+ * - diagnostics_size: Number of characters in diagnostics.
+ * - is_cached: Whether its object file was taken from the cache.
+ */
+typedef struct
+{
+    char *input;
+    char *output;
+    int status;
+    char *diagnostics;
+    size_t diagnostics_size;
+    int is_cached;
+} batch_file_t;
+
+/*
+ * A batch struct contains the following fields:
+ * - files: Files to be assembled, in order.
+ * - count: Number of files.
+ * - capacity: Number of files allocated, which grows geometrically.
+ * - manifest: Source buffer of the manifest, which holds the names listed there.
+ * - max_errors: Number of errors after which the assembly of a file stops, or 0 for
+ *               stopping at the first one.
+ * - cache: Cache of object files, or NULL.
+ * - arenas: Arena of each worker while the batch runs, or NULL.
+ */
+typedef struct
+{
+    batch_file_t *files;
+    int count;
+    int capacity;
+    source_t manifest;
+    int max_errors;
+    cache_t *cache;
+    arena_t *arenas;
+} batch_t;
+
+void batch_init(batch_t *batch);
+void batch_destroy(batch_t *batch);
+void batch_add(batch_t *batch, char *input);
+void batch_add_manifest(batch_t *batch, char *filename);
+char* batch_output_name(const char *input);
+void batch_run(batch_t *batch, int jobs);
+void batch_assemble_file(int index, int worker, void *arg);
+void batch_assemble_source(batch_t *batch, batch_file_t *file, arena_t *arena);
+int batch_report(batch_t *batch);
+
+#endif /* _BATCH_H_ */
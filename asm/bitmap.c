@@ -0,0 +1,77 @@
+/**
+ * @file   bitmap.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements a growable bitmap
+ */
+
+#include "bitmap.h"
+
+/**
+ * Init an empty bitmap, with every bit cleared.
+ * @param bitmap Pointer to a bitmap struct.
+ */
+void bitmap_init(bitmap_t *bitmap)
+{
+    bitmap->words = calloc(BITMAP_INITIAL_CAPACITY, sizeof(unsigned long));
+    bitmap->capacity = BITMAP_INITIAL_CAPACITY;
+    
+    if (!bitmap->words)
+        error(ERROR_FILE, "Cannot allocate memory for bitmap");
+}
+
+/**
+ * Free the memory used by a bitmap.
+ * @param bitmap Pointer to a bitmap struct.
+ */
+void bitmap_destroy(bitmap_t *bitmap)
+{
+    free(bitmap->words);
+    bitmap->words = NULL;
+    bitmap->capacity = 0;
+}
+
+/**
+ * Set a bit, growing the bitmap when the index does not fit.
+ * @param bitmap Pointer to a bitmap struct.
+ * @param index Index of the bit, which must not be negative.
+ */
+void bitmap_set(bitmap_t *bitmap, int index)
+{
+    int word = index/BITMAP_WORD_BITS;
+    int capacity = bitmap->capacity;
+    
+    if (word >= capacity)
+    {
+        while (word >= capacity)
+            capacity *= 2;
+        
+        bitmap->words = realloc(bitmap->words, sizeof(unsigned long)*capacity);
+        
+        if (!bitmap->words)
+            error(ERROR_FILE, "Cannot allocate memory for bitmap");
+        
+        memset(&bitmap->words[bitmap->capacity], 0,
+               sizeof(unsigned long)*(capacity - bitmap->capacity));
+        bitmap->capacity = capacity;
+    }
+    
+    bitmap->words[word] |= 1UL << (index%BITMAP_WORD_BITS);
+}
+
+/**
+ * Test whether a bit is set.
+ * @param bitmap Pointer to a bitmap struct.
+ * @param index Index of the bit.
+ * @return 1 if the bit is set or 0 otherwise, including indexes past the end.
+ */
+int bitmap_test(const bitmap_t *bitmap, int index)
+{
+    int word = index/BITMAP_WORD_BITS;
+    
+    if ((index < 0) || (word >= bitmap->capacity))
+        return 0;
+    
+    return (bitmap->words[word] >> (index%BITMAP_WORD_BITS)) & 1;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file   bitmap.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares a growable bitmap
+ *
+ * A bitmap keeps one bit for each non-negative index, all of them cleared at first. It
+ * grows geometrically when a bit past its end is set, and bits past its end read as
+ * cleared, so testing a bit never allocates.
+ *
+ * Example usage
+ *
+    bitmap_t bitmap;
+    
+    bitmap_init(&bitmap);
+    bitmap_set(&bitmap, 42);
+    
+    if (bitmap_test(&bitmap, 42))
+        printf("Bit 42 is set\n");
+    
+    bitmap_destroy(&bitmap);
+ */
+
+#ifndef _BITMAP_H_
+#define _BITMAP_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+
+/* Initial number of words of the bitmap */
+#define BITMAP_INITIAL_CAPACITY 16
+
+/* Number of bits in each word */
+#define BITMAP_WORD_BITS (8*sizeof(unsigned long))
+
+/*
+ * A bitmap struct contains the following fields:
+ * - words: Bits, from the least significant bit of the first word onwards.
+ * - capacity: Number of words allocated.
+ */
+typedef struct
+{
+    unsigned long *words;
+    int capacity;
+} bitmap_t;
+
+void bitmap_init(bitmap_t *bitmap);
+void bitmap_destroy(bitmap_t *bitmap);
+void bitmap_set(bitmap_t *bitmap, int index);
+int bitmap_test(const bitmap_t *bitmap, int index);
+
+#endif /* _BITMAP_H_ */
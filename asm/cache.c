@@ -0,0 +1,486 @@
+/**
+ * @file   cache.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the incremental assembly cache
+ *
+ * The hash is MurmurHash3 in its 128-bit variant for 32-bit words, so it only needs 32-bit
+ * arithmetic, which C89 guarantees with unsigned long. Several assemblies, in this process
+ * or in others, may use the same cache at once: entries only appear through a link or a
+ * rename, and files which vanish while evicting are skipped.
+ */
+
+#include "cache.h"
+
+/* Extension of the entry file of each kind of output */
+static const char *cache_extensions[CACHE_KIND_COUNT] = {".obj", ".pre", ".lst"};
+
+/**
+ * Init a cache, creating its directory when it does not exist.
+ * @param cache Pointer to a cache struct.
+ * @param directory Directory of the entry files, which must be valid while the cache is
+ *                  used.
+ * @param limit Size limit of the entry files, in bytes.
+ * @return CACHE_OK if the directory can be used or CACHE_ERROR otherwise.
+ */
+int cache_init(cache_t *cache, char *directory, long limit)
+{
+    struct stat dir_stat;
+    
+    cache->directory = directory;
+    cache->limit = limit;
+    
+    if ((mkdir(directory, 0777) != 0) && (errno != EEXIST))
+        return CACHE_ERROR;
+    
+    if ((stat(directory, &dir_stat) != 0) || !S_ISDIR(dir_stat.st_mode))
+        return CACHE_ERROR;
+    
+    return CACHE_OK;
+}
+
+/**
+ * Compute the key of a source file, hashing the assembler version, followed by a '\0',
+ * and the bytes of the file. Only regular files have a key, since reading a pipe would
+ * leave nothing for the assembler.
+ * @param filename Source file name.
+ * @param key Stores the key, as CACHE_KEY_SIZE hexadecimal digits and a '\0'.
+ * @return CACHE_OK if the key was computed or CACHE_ERROR otherwise.
+ */
+int cache_key(const char *filename, char *key)
+{
+    FILE *fp = fopen(filename, "rb");
+    struct stat file_stat;
+    unsigned char *data;
+    unsigned long hash[4];
+    size_t salt_size = strlen(CACHE_VERSION) + 1;
+    size_t size;
+    int i;
+    
+    if (!fp)
+        return CACHE_ERROR;
+    
+    if ((fstat(fileno(fp), &file_stat) != 0) || !S_ISREG(file_stat.st_mode) ||
+        !(data = malloc(salt_size + file_stat.st_size + 1)))
+    {
+        fclose(fp);
+        return CACHE_ERROR;
+    }
+    
+    memcpy(data, CACHE_VERSION, salt_size);
+    size = fread(data + salt_size, 1, file_stat.st_size + 1, fp);
+    
+    /* The file changed while being read, so it may change again before assembling */
+    if (ferror(fp) || (size != (size_t)file_stat.st_size))
+    {
+        fclose(fp);
+        free(data);
+        return CACHE_ERROR;
+    }
+    
+    fclose(fp);
+    cache_hash(data, salt_size + size, hash);
+    free(data);
+    
+    for (i = 0; i < 4; ++i)
+        sprintf(key + 8*i, "%08lx", hash[i]);
+    
+    return CACHE_OK;
+}
+
+/**
+ * Hash a block of memory with 128-bit MurmurHash3, for 32-bit words, with a zero seed.
+ * Words are read in little-endian order, so the hash does not depend on the host.
+ * @param data Bytes to be hashed.
+ * @param size Number of bytes.
+ * @param hash Stores the hash, as four 32-bit words.
+ */
+void cache_hash(const unsigned char *data, size_t size, unsigned long hash[4])
+{
+    static const unsigned long c[4] = {0x239b961bUL, 0xab0e9789UL, 0x38b34ae5UL,
+                                       0xa1e38b93UL};
+    static const int k_rotations[4] = {15, 16, 17, 18};
+    static const int h_rotations[4] = {19, 17, 15, 13};
+    static const unsigned long h_additions[4] = {0x561ccd1bUL, 0x0bcaa747UL,
+                                                 0x96cd1c35UL, 0x32ac3b17UL};
+    unsigned long h[4] = {0, 0, 0, 0};
+    unsigned long k[4];
+    size_t blocks = size/16;
+    size_t block;
+    size_t i;
+    int j;
+    
+    for (block = 0; block < blocks; ++block, data += 16)
+    {
+        for (j = 0; j < 4; ++j)
+            k[j] = (unsigned long)data[4*j] | ((unsigned long)data[4*j + 1] << 8) |
+                   ((unsigned long)data[4*j + 2] << 16) |
+                   ((unsigned long)data[4*j + 3] << 24);
+        
+        for (j = 0; j < 4; ++j)
+        {
+            k[j] = CACHE_U32(k[j]*c[j]);
+            k[j] = CACHE_ROTL32(k[j], k_rotations[j]);
+            h[j] ^= CACHE_U32(k[j]*c[(j + 1)%4]);
+            
+            h[j] = CACHE_ROTL32(h[j], h_rotations[j]);
+            h[j] = CACHE_U32(h[j] + h[(j + 1)%4]);
+            h[j] = CACHE_U32(h[j]*5 + h_additions[j]);
+        }
+    }
+    
+    /* Tail of up to 15 bytes, mixed as zero-padded words; zero words leave h unchanged */
+    k[0] = k[1] = k[2] = k[3] = 0;
+    
+    for (i = 0; i < size%16; ++i)
+        k[i/4] |= (unsigned long)data[i] << (8*(i%4));
+    
+    for (j = 3; j >= 0; --j)
+    {
+        k[j] = CACHE_U32(k[j]*c[j]);
+        k[j] = CACHE_ROTL32(k[j], k_rotations[j]);
+        h[j] ^= CACHE_U32(k[j]*c[(j + 1)%4]);
+    }
+    
+    /* Finalization, mixing the words into each other */
+    for (j = 0; j < 4; ++j)
+        h[j] ^= CACHE_U32((unsigned long)size);
+    
+    h[0] = CACHE_U32(h[0] + h[1] + h[2] + h[3]);
+    for (j = 1; j < 4; ++j)
+        h[j] = CACHE_U32(h[j] + h[0]);
+    
+    for (j = 0; j < 4; ++j)
+    {
+        h[j] ^= h[j] >> 16;
+        h[j] = CACHE_U32(h[j]*0x85ebca6bUL);
+        h[j] ^= h[j] >> 13;
+        h[j] = CACHE_U32(h[j]*0xc2b2ae35UL);
+        h[j] ^= h[j] >> 16;
+    }
+    
+    h[0] = CACHE_U32(h[0] + h[1] + h[2] + h[3]);
+    for (j = 1; j < 4; ++j)
+        h[j] = CACHE_U32(h[j] + h[0]);
+    
+    for (j = 0; j < 4; ++j)
+        hash[j] = h[j];
+}
+
+/**
+ * Install the outputs of an assembly from the cache. Nothing is installed unless every
+ * requested output has an entry, and the entries used are touched.
+ * @param cache Pointer to a cache struct.
+ * @param key Key of the source file.
+ * @param outputs File name of each kind of output, or NULL when it is not requested.
+ * @return CACHE_OK if every output was installed, CACHE_MISS if an entry is missing or
+ *         CACHE_ERROR if an output could not be installed.
+ */
+int cache_fetch(cache_t *cache, const char *key, char **outputs)
+{
+    char *entries[CACHE_KIND_COUNT];
+    int status = CACHE_OK;
+    int kind;
+    
+    for (kind = 0; kind < CACHE_KIND_COUNT; ++kind)
+    {
+        entries[kind] = NULL;
+        
+        if (!outputs[kind] || (status != CACHE_OK))
+            continue;
+        
+        if (!(entries[kind] = cache_path(cache, key, cache_extensions[kind])))
+            status = CACHE_ERROR;
+        else if (access(entries[kind], R_OK) != 0)
+            status = CACHE_MISS;
+    }
+    
+    for (kind = 0; (kind < CACHE_KIND_COUNT) && (status == CACHE_OK); ++kind)
+    {
+        if (!outputs[kind])
+            continue;
+        
+        status = cache_install(entries[kind], outputs[kind], kind == CACHE_OBJECT);
+        
+        /* Used entries are the most recent, for eviction */
+        utime(entries[kind], NULL);
+    }
+    
+    for (kind = 0; kind < CACHE_KIND_COUNT; ++kind)
+        free(entries[kind]);
+    
+    return status;
+}
+
+/**
+ * Add the outputs of a successful assembly to the cache.
+ * @param cache Pointer to a cache struct.
+ * @param key Key of the source file.
+ * @param outputs File name of each kind of output, or NULL when it was not written.
+ * @return CACHE_OK if every output was added or CACHE_ERROR otherwise.
+ */
+int cache_store(cache_t *cache, const char *key, char **outputs)
+{
+    char *entry;
+    int status = CACHE_OK;
+    int kind;
+    
+    for (kind = 0; (kind < CACHE_KIND_COUNT) && (status == CACHE_OK); ++kind)
+    {
+        if (!outputs[kind])
+            continue;
+        
+        if (!(entry = cache_path(cache, key, cache_extensions[kind])))
+            return CACHE_ERROR;
+        
+        status = cache_add(cache, outputs[kind], entry, kind == CACHE_OBJECT);
+        free(entry);
+    }
+    
+    return status;
+}
+
+/**
+ * Remove the least recently used entries until the cache fits its size limit. Files
+ * being copied into the cache are left alone.
+ * @param cache Pointer to a cache struct.
+ */
+void cache_evict(cache_t *cache)
+{
+    DIR *dir = opendir(cache->directory);
+    struct dirent *dirent;
+    struct stat file_stat;
+    cache_file_t *files = NULL;
+    cache_file_t *grown;
+    int count = 0;
+    int capacity = 0;
+    long total = 0;
+    char *path;
+    int i;
+    
+    if (!dir)
+        return;
+    
+    while ((dirent = readdir(dir)))
+    {
+        if ((dirent->d_name[0] == '.') ||
+            (strncmp(dirent->d_name, CACHE_TEMP_PREFIX, strlen(CACHE_TEMP_PREFIX)) == 0))
+            continue;
+        
+        if (!(path = cache_path(cache, dirent->d_name, "")))
+            break;
+        
+        if ((stat(path, &file_stat) != 0) || !S_ISREG(file_stat.st_mode))
+        {
+            free(path);
+            continue;
+        }
+        
+        if (count == capacity)
+        {
+            capacity = capacity ? 2*capacity : 64;
+            
+            if (!(grown = realloc(files, sizeof(cache_file_t)*capacity)))
+            {
+                free(path);
+                break;
+            }
+            
+            files = grown;
+        }
+        
+        files[count].name = path;
+        files[count].size = file_stat.st_size;
+        files[count].used = file_stat.st_mtim.tv_sec;
+        files[count].used_nsec = file_stat.st_mtim.tv_nsec;
+        total += file_stat.st_size;
+        ++count;
+    }
+    
+    closedir(dir);
+    
+    if (total > cache->limit)
+    {
+        qsort(files, count, sizeof(cache_file_t), cache_compare_files);
+        
+        for (i = 0; (i < count) && (total > cache->limit); ++i)
+            if ((remove(files[i].name) == 0) || (errno == ENOENT))
+                total -= files[i].size;
+    }
+    
+    for (i = 0; i < count; ++i)
+        free(files[i].name);
+    
+    free(files);
+}
+
+/**
+ * Build the path of a file in the cache directory.
+ * @param cache Pointer to a cache struct.
+ * @param name Name of the file, without its extension.
+ * @param extension Extension of the file, which may be empty.
+ * @return path, which must be freed, or NULL if there is no memory left for it.
+ */
+char* cache_path(cache_t *cache, const char *name, const char *extension)
+{
+    char *path = malloc(strlen(cache->directory) + strlen(name) + strlen(extension) + 2);
+    
+    if (path)
+        sprintf(path, "%s/%s%s", cache->directory, name, extension);
+    
+    return path;
+}
+
+/**
+ * Install an output from its entry file, under a partial name renamed over the output
+ * once complete, so the output is never left half-written.
+ * @param entry Entry file name.
+ * @param output Output file name.
+ * @param is_linked Whether the output may share the entry file through a hard link,
+ *                  otherwise it is copied.
+ * @return CACHE_OK if the output was installed or CACHE_ERROR otherwise.
+ */
+int cache_install(const char *entry, const char *output, int is_linked)
+{
+    char *partial = malloc(strlen(output) + strlen(CACHE_PARTIAL_SUFFIX) + 1);
+    FILE *fp;
+    int status = CACHE_OK;
+    
+    if (!partial)
+        return CACHE_ERROR;
+    
+    strcpy(partial, output);
+    strcat(partial, CACHE_PARTIAL_SUFFIX);
+    remove(partial);
+    
+    if (!is_linked || (link(entry, partial) != 0))
+    {
+        if ((fp = fopen(partial, "wb")))
+        {
+            status = cache_copy(entry, fp);
+            
+            if (fclose(fp) != 0)
+                status = CACHE_ERROR;
+        }
+        else
+        {
+            status = CACHE_ERROR;
+        }
+    }
+    
+    if ((status == CACHE_OK) && (rename(partial, output) != 0))
+        status = CACHE_ERROR;
+    
+    if (status != CACHE_OK)
+        remove(partial);
+    
+    free(partial);
+    return status;
+}
+
+/**
+ * Add an output to the cache as a new entry file. A hard link appears at once under the
+ * entry name; a copy is written to a temporary file in the cache directory, renamed to the
+ * entry name once complete.
+ * @param cache Pointer to a cache struct.
+ * @param output Output file name.
+ * @param entry Entry file name.
+ * @param is_linked Whether the entry may share the output file through a hard link,
+ *                  otherwise it is copied.
+ * @return CACHE_OK if the entry was added or CACHE_ERROR otherwise.
+ */
+int cache_add(cache_t *cache, const char *output, const char *entry, int is_linked)
+{
+    char *temp;
+    FILE *fp;
+    int fd;
+    int status = CACHE_OK;
+    
+    /* An entry which already exists has the same contents, as it has the same key */
+    if (is_linked && ((link(output, entry) == 0) || (errno == EEXIST)))
+        return CACHE_OK;
+    
+    if (!(temp = cache_path(cache, CACHE_TEMP_PREFIX "XXXXXX", "")))
+        return CACHE_ERROR;
+    
+    if ((fd = mkstemp(temp)) == -1)
+    {
+        free(temp);
+        return CACHE_ERROR;
+    }
+    
+    if ((fp = fdopen(fd, "wb")))
+    {
+        status = cache_copy(output, fp);
+        
+        if (fclose(fp) != 0)
+            status = CACHE_ERROR;
+    }
+    else
+    {
+        close(fd);
+        status = CACHE_ERROR;
+    }
+    
+    if ((status == CACHE_OK) && (rename(temp, entry) != 0))
+        status = CACHE_ERROR;
+    
+    if (status != CACHE_OK)
+        remove(temp);
+    
+    free(temp);
+    return status;
+}
+
+/**
+ * Copy the contents of a file to an open file.
+ * @param from Name of the file copied.
+ * @param to File copied to, which is not closed.
+ * @return CACHE_OK if the whole file was copied or CACHE_ERROR otherwise.
+ */
+int cache_copy(const char *from, FILE *to)
+{
+    FILE *fp = fopen(from, "rb");
+    char buffer[CACHE_COPY_SIZE];
+    size_t size;
+    int status = CACHE_OK;
+    
+    if (!fp)
+        return CACHE_ERROR;
+    
+    while ((size = fread(buffer, 1, CACHE_COPY_SIZE, fp)) > 0)
+    {
+        if (fwrite(buffer, 1, size, to) != size)
+        {
+            status = CACHE_ERROR;
+            break;
+        }
+    }
+    
+    if (ferror(fp))
+        status = CACHE_ERROR;
+    
+    fclose(fp);
+    return status;
+}
+
+/**
+ * Compare two entry files by the time they were last used, oldest first.
+ * @param a Pointer to a cache file.
+ * @param b Pointer to another cache file.
+ * @return negative, zero or positive as a was used before, with or after b.
+ */
+int cache_compare_files(const void *a, const void *b)
+{
+    const cache_file_t *first = a;
+    const cache_file_t *second = b;
+    
+    if (first->used != second->used)
+        return (first->used < second->used) ? -1 : 1;
+    
+    if (first->used_nsec != second->used_nsec)
+        return (first->used_nsec < second->used_nsec) ? -1 : 1;
+    
+    return 0;
+}
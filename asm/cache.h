@@ -0,0 +1,142 @@
+/**
+ * @file   cache.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the incremental assembly cache
+ *
+ * The cache keeps the outputs of previous assemblies in a directory, so a source file
+ * which did not change is not assembled again. Its key is a 128-bit MurmurHash3 of the
+ * source bytes, salted with the assembler version, written as 32 hexadecimal digits.
+ * Each output is an entry file named after the key and the extension of its kind: the
+ * object file, the preprocessed file and the listing.
+ *
+ * On a hit, every requested output is installed from its entry without parsing the
+ * source: the object file is hard-linked when possible, since the assembler always
+ * replaces it by renaming, while the text outputs are copied, since they are written in
+ * place. On a miss, the outputs of a successful assembly are added to the cache: a new
+ * entry is either a hard link or a complete copy renamed into place, so other assemblies
+ * never see it half-written. Entries are touched when used, and the least recently used
+ * ones are removed once the cache grows past its size limit.
+ *
+ * The cache is only an optimization, so its routines never stop the assembly: they
+ * return an error status, and callers just assemble as if there was no cache.
+ *
+ * Example usage
+ *
+    cache_t cache;
+    char key[CACHE_KEY_SIZE + 1];
+    char *outputs[CACHE_KIND_COUNT] = {NULL, NULL, NULL};
+    
+    outputs[CACHE_OBJECT] = "program.obj";
+    cache_init(&cache, ".sbcache", CACHE_DEFAULT_LIMIT);
+    
+    if ((cache_key("program.asm", key) == CACHE_OK) &&
+        (cache_fetch(&cache, key, outputs) == CACHE_OK))
+        printf("Reused program.obj\n");
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+/*
+ * Identifies the build of the assembler. The Makefile gives a checksum of the sources, and
+ * compiling by hand falls back to the time cache.c was compiled.
+ */
+#ifndef CACHE_BUILD_ID
+#define CACHE_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+/* Salt of every key, so another build of the assembler never reuses old entries */
+#define CACHE_VERSION "sbasm " CACHE_BUILD_ID
+
+/* Number of hexadecimal digits of a key */
+#define CACHE_KEY_SIZE 32
+
+/* Size limit of the cache when none is given, in bytes */
+#define CACHE_DEFAULT_LIMIT (64L*1024*1024)
+
+/* Prefix of the temporary files of entries being copied into the cache */
+#define CACHE_TEMP_PREFIX "tmp."
+
+/* Suffix of an output while it is being installed from the cache */
+#define CACHE_PARTIAL_SUFFIX ".part"
+
+/* Number of bytes copied at once */
+#define CACHE_COPY_SIZE 65536
+
+/* Truncate to 32 bits, as unsigned long may be wider */
+#define CACHE_U32(x) ((x) & 0xFFFFFFFFUL)
+
+/* Rotate a 32-bit word left */
+#define CACHE_ROTL32(x, r) CACHE_U32(((x) << (r)) | (CACHE_U32(x) >> (32 - (r))))
+
+/**
+ * Status returned by the cache routines.
+ */
+enum
+{
+    CACHE_OK,
+    CACHE_MISS,
+    CACHE_ERROR
+};
+
+/**
+ * Kinds of outputs kept in the cache, which index the outputs arrays.
+ */
+typedef enum
+{
+    CACHE_OBJECT,
+    CACHE_PREPROCESSED,
+    CACHE_LISTING,
+    CACHE_KIND_COUNT
+} cache_kind_t;
+
+/*
+ * A cache struct contains the following fields:
+ * - directory: Directory of the entry files.
+ * - limit: Size limit of the entry files, in bytes.
+ */
+typedef struct
+{
+    char *directory;
+    long limit;
+} cache_t;
+
+/*
+ * A cache file struct describes an entry file while evicting, with its size and the time
+ * it was last used, in seconds and nanoseconds, so entries used within the same second
+ * are still told apart.
+ */
+typedef struct
+{
+    char *name;
+    long size;
+    time_t used;
+    long used_nsec;
+} cache_file_t;
+
+int cache_init(cache_t *cache, char *directory, long limit);
+int cache_key(const char *filename, char *key);
+void cache_hash(const unsigned char *data, size_t size, unsigned long hash[4]);
+int cache_fetch(cache_t *cache, const char *key, char **outputs);
+int cache_store(cache_t *cache, const char *key, char **outputs);
+void cache_evict(cache_t *cache);
+char* cache_path(cache_t *cache, const char *name, const char *extension);
+int cache_install(const char *entry, const char *output, int is_linked);
+int cache_add(cache_t *cache, const char *output, const char *entry, int is_linked);
+int cache_copy(const char *from, FILE *to);
+int cache_compare_files(const void *a, const void *b);
+
+#endif /* _CACHE_H_ */
@@ -0,0 +1,209 @@
+/**
+ * @file   context.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements assembly contexts
+ *
+ * The current context of each thread is kept in thread-specific data, since C89 has no
+ * thread-local variables. The key is created only once, by whichever thread needs it
+ * first.
+ */
+
+#include "context.h"
+
+static pthread_key_t context_key;
+static pthread_once_t context_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Init a context with no pending cleanups.
+ * @param context Pointer to a context struct.
+ * @param out Stream for progress, or NULL for not printing it.
+ * @param err Stream for error messages.
+ */
+void context_init(context_t *context, FILE *out, FILE *err)
+{
+    context->out = out;
+    context->err = err;
+    context->report = NULL;
+    context->report_arg = NULL;
+    context->arena = NULL;
+    context->status = 0;
+    context->cleanup_count = 0;
+}
+
+/**
+ * Make a context the current one of the calling thread.
+ * @param context Pointer to a context struct.
+ */
+void context_enter(context_t *context)
+{
+    pthread_once(&context_key_once, context_create_key);
+    pthread_setspecific(context_key, context);
+}
+
+/**
+ * Leave the current context of the calling thread, which then has none.
+ */
+void context_leave(void)
+{
+    pthread_once(&context_key_once, context_create_key);
+    pthread_setspecific(context_key, NULL);
+}
+
+/**
+ * Get the current context of the calling thread.
+ * @return pointer to the context or NULL if the thread has not entered one.
+ */
+context_t* context_current(void)
+{
+    pthread_once(&context_key_once, context_create_key);
+    return pthread_getspecific(context_key);
+}
+
+/**
+ * Push a cleanup to the current context. Does nothing without a context, since errors
+ * then exit the program.
+ * @param routine Routine releasing a resource.
+ * @param arg Argument of the routine. It must not be in a stack frame which an error
+ *            may jump out of.
+ */
+void context_push_cleanup(void (*routine)(void*), void *arg)
+{
+    context_t *context = context_current();
+    
+    if (!context)
+        return;
+    
+    if (context->cleanup_count == CONTEXT_MAX_CLEANUPS)
+    {
+        fprintf(context->err, "Too many pending cleanups\n");
+        abort();
+    }
+    
+    context->cleanups[context->cleanup_count].routine = routine;
+    context->cleanups[context->cleanup_count].arg = arg;
+    ++context->cleanup_count;
+}
+
+/**
+ * Pop the last cleanup pushed to the current context, without running it, as its resource
+ * is being released. Does nothing if the last cleanup is not the one of the resource,
+ * which is the case when the cleanup itself is running.
+ * @param arg Argument of the cleanup.
+ */
+void context_pop_cleanup(void *arg)
+{
+    context_t *context = context_current();
+    
+    if (context && (context->cleanup_count > 0) &&
+        (context->cleanups[context->cleanup_count - 1].arg == arg))
+        --context->cleanup_count;
+}
+
+/**
+ * Run the pending cleanups of a context, from the last one pushed to the first one. Each
+ * one is popped before it runs.
+ * @param context Pointer to a context struct.
+ */
+void context_cleanup(context_t *context)
+{
+    while (context->cleanup_count > 0)
+    {
+        --context->cleanup_count;
+        context->cleanups[context->cleanup_count].routine(
+            context->cleanups[context->cleanup_count].arg);
+    }
+}
+
+/**
+ * Stop the assembly after an error. Jumps back to the current context, or exits the
+ * program if the thread has none. The status of the context is kept if an earlier error
+ * let the assembly keep going.
+ * @param status Error type.
+ */
+void context_fail(int status)
+{
+    context_t *context = context_current();
+    
+    if (!context)
+        exit(status);
+    
+    if (!context->status)
+        context->status = status;
+    
+    longjmp(context->jump, 1);
+}
+
+/**
+ * Stop the assembly if any error was found while it kept going. Called once every error
+ * which can be found was reported, before writing any output.
+ */
+void context_check_errors(void)
+{
+    context_t *context = context_current();
+    
+    if (context && context->status)
+        context_fail(context->status);
+}
+
+/**
+ * Get the stream for error messages of the calling thread.
+ * @return error stream of the current context, or stderr without a context.
+ */
+FILE* context_err(void)
+{
+    context_t *context = context_current();
+    
+    return context ? context->err : stderr;
+}
+
+/**
+ * Get the arena lent to the assembly running on the calling thread.
+ * @return arena of the current context, or NULL if there is none.
+ */
+arena_t* context_arena(void)
+{
+    context_t *context = context_current();
+    
+    return context ? context->arena : NULL;
+}
+
+/**
+ * Check whether progress is printed on the calling thread, so callers can skip
+ * collecting progress which would be thrown away.
+ * @return 1 if the current context has an output stream or 0 otherwise.
+ */
+int context_has_progress(void)
+{
+    context_t *context = context_current();
+    
+    return context && context->out;
+}
+
+/**
+ * Print progress to the output stream of the calling thread, as printf does. Progress is
+ * not printed without a context, nor when the context has no output stream.
+ * @param format Format of the message.
+ */
+void context_printf(const char *format, ...)
+{
+    context_t *context = context_current();
+    FILE *out = context ? context->out : NULL;
+    va_list args;
+    
+    if (!out)
+        return;
+    
+    va_start(args, format);
+    vfprintf(out, format, args);
+    va_end(args);
+}
+
+/**
+ * Create the key of the current context of each thread. Called only once.
+ */
+void context_create_key(void)
+{
+    pthread_key_create(&context_key, NULL);
+}
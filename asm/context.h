@@ -0,0 +1,100 @@
+/**
+ * @file   context.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares assembly contexts
+ *
+ * A context lets several files be assembled in the same process, each one on its own
+ * thread. While a thread has entered a context, progress is printed to the output stream
+ * of the context, errors are printed to its error stream and, instead of exiting the
+ * program, an error jumps back to where the context was set up. The memory held by the
+ * failed assembly is then released by the cleanups it had pushed.
+ * Threads which have not entered a context print no progress, print errors to stderr and
+ * exit on errors, as a single assembly always did.
+ *
+ * Example usage
+ *
+    context_t context;
+    
+    context_init(&context, NULL, stderr);
+    context_enter(&context);
+    
+    if (setjmp(context.jump) == 0)
+        assemble_something();
+    
+    context_cleanup(&context);
+    context_leave();
+    
+    if (context.status)
+        printf("Failed with error %d\n", context.status);
+ */
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <pthread.h>
+#include "arena.h"
+
+/* Maximum number of cleanups pending at once */
+#define CONTEXT_MAX_CLEANUPS 8
+
+/**
+ * Cleanup of a resource, run if an error stops the assembly before it is released.
+ */
+typedef struct
+{
+    void (*routine)(void*);
+    void *arg;
+} cleanup_t;
+
+/*
+ * A context struct contains the following fields:
+ * - jump: Where errors jump to. It must be set with setjmp by the caller of the assembly,
+ *         and the frame which called setjmp must still be running.
+ * - out: Stream for progress, or NULL for not printing it.
+ * - err: Stream for error messages.
+ * - report: Routine given each error message instead of printing it, or NULL. It gets
+ *           report_arg, the error type, the line number, or 0 if there is none, and the
+ *           message. It returns 1 to keep the assembly going after an error found at a
+ *           line, or 0 to stop it.
+ * - report_arg: Argument of report.
+ * - arena: Arena lent to the assembly for its interned strings, or NULL. Its owner resets
+ *          it once the assembly is over.
+ * - status: Error type of the first error of the assembly, or 0.
+ * - cleanups: Cleanups pending, run in reverse order after an error.
+ * - cleanup_count: Number of cleanups pending.
+ */
+typedef struct
+{
+    jmp_buf jump;
+    FILE *out;
+    FILE *err;
+    int (*report)(void*, int, int, const char*);
+    void *report_arg;
+    arena_t *arena;
+    int status;
+    cleanup_t cleanups[CONTEXT_MAX_CLEANUPS];
+    int cleanup_count;
+} context_t;
+
+void context_init(context_t *context, FILE *out, FILE *err);
+void context_enter(context_t *context);
+void context_leave(void);
+context_t* context_current(void);
+void context_push_cleanup(void (*routine)(void*), void *arg);
+void context_pop_cleanup(void *arg);
+void context_cleanup(context_t *context);
+void context_fail(int status);
+void context_check_errors(void);
+FILE* context_err(void);
+arena_t* context_arena(void);
+int context_has_progress(void);
+void context_printf(const char *format, ...);
+void context_create_key(void);
+
+#endif /* _CONTEXT_H_ */
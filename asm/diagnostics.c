@@ -0,0 +1,135 @@
+/**
+ * @file   diagnostics.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the diagnostics buffer
+ *
+ * Collecting an error never allocates, so errors can be collected even when memory is
+ * short. A reference to a label which fails a check fails it for each of its uses, so an
+ * error identical to the last one collected is only kept once.
+ */
+
+#include "diagnostics.h"
+
+/**
+ * Init an empty diagnostics buffer, allocating all its entries. It does not stop the
+ * program when out of memory, as it is set up before the assembly context it serves.
+ * @param diagnostics Pointer to a diagnostics struct.
+ * @param capacity Maximum number of errors collected, at least 1.
+ * @return 1 if the entries were allocated or 0 if out of memory.
+ */
+int diagnostics_init(diagnostics_t *diagnostics, int capacity)
+{
+    diagnostics->entries = malloc(sizeof(diagnostic_t)*capacity);
+    diagnostics->count = 0;
+    diagnostics->capacity = diagnostics->entries ? capacity : 0;
+    diagnostics->is_truncated = 0;
+    
+    return diagnostics->entries != NULL;
+}
+
+/**
+ * Free the memory used by a diagnostics buffer.
+ * @param diagnostics Pointer to a diagnostics struct.
+ */
+void diagnostics_destroy(diagnostics_t *diagnostics)
+{
+    free(diagnostics->entries);
+    diagnostics->entries = NULL;
+    diagnostics->count = 0;
+    diagnostics->capacity = 0;
+    diagnostics->is_truncated = 0;
+}
+
+/**
+ * Report routine of an assembly context, which collects an error. An error found once
+ * the buffer is full is left out, and stops the assembly.
+ * @param diagnostics Pointer to a diagnostics struct.
+ * @param type Error type.
+ * @param line_number Line number at which the error occurred, or 0 if there is none.
+ * @param message Error message.
+ * @return 1 if the assembly may keep going or 0 if the error was left out.
+ */
+int diagnostics_report(void *diagnostics, int type, int line_number, const char *message)
+{
+    diagnostics_t *buffer = diagnostics;
+    diagnostic_t *entry;
+    
+    if (buffer->count > 0)
+    {
+        entry = &buffer->entries[buffer->count - 1];
+        
+        if ((entry->type == type) && (entry->line_number == line_number) &&
+            (strcmp(entry->message, message) == 0))
+            return 1;
+    }
+    
+    if (buffer->count == buffer->capacity)
+    {
+        buffer->is_truncated = 1;
+        return 0;
+    }
+    
+    entry = &buffer->entries[buffer->count];
+    entry->type = type;
+    entry->line_number = line_number;
+    entry->order = buffer->count;
+    strncpy(entry->message, message, ERROR_MESSAGE_SIZE - 1);
+    entry->message[ERROR_MESSAGE_SIZE - 1] = '\0';
+    ++buffer->count;
+    
+    return 1;
+}
+
+/**
+ * Sort the errors collected by line number, keeping the order they were collected in
+ * for errors at the same line.
+ * @param diagnostics Pointer to a diagnostics struct.
+ */
+void diagnostics_sort(diagnostics_t *diagnostics)
+{
+    qsort(diagnostics->entries, diagnostics->count, sizeof(diagnostic_t),
+          diagnostics_compare);
+}
+
+/**
+ * Compare two errors by line number and then by order.
+ * @param first Pointer to a diagnostic struct.
+ * @param second Pointer to a diagnostic struct.
+ * @return negative, zero or positive as first comes before, with or after second.
+ */
+int diagnostics_compare(const void *first, const void *second)
+{
+    const diagnostic_t *a = first;
+    const diagnostic_t *b = second;
+    
+    if (a->line_number != b->line_number)
+        return (a->line_number < b->line_number) ? -1 : 1;
+    
+    return a->order - b->order;
+}
+
+/**
+ * Print the errors collected, sorted by line number. A note follows them when an error was
+ * left out, since the assembly stopped there.
+ * @param diagnostics Pointer to a diagnostics struct.
+ * @param err Stream for error messages.
+ */
+void diagnostics_print(diagnostics_t *diagnostics, FILE *err)
+{
+    diagnostic_t *entry;
+    int i;
+    
+    diagnostics_sort(diagnostics);
+    
+    for (i = 0; i < diagnostics->count; ++i)
+    {
+        entry = &diagnostics->entries[i];
+        print_error_prefix(err, entry->type, entry->line_number);
+        fprintf(err, "%s\n", entry->message);
+    }
+    
+    if (diagnostics->is_truncated)
+        fprintf(err, "Stopped after %d errors\n", diagnostics->capacity);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file   diagnostics.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the diagnostics buffer
+ *
+ * A diagnostics buffer collects the errors of an assembly which keeps going after them,
+ * so they are all reported at once instead of one per run. It is the report routine of
+ * the assembly context: each error is copied into an entry preallocated for it, and the
+ * assembly only stops once the buffer is full. The errors are then printed sorted by
+ * line number, in the same format as when the first error stops the assembly.
+ *
+ * Example usage
+ *
+    diagnostics_t diagnostics;
+    
+    diagnostics_init(&diagnostics, DIAGNOSTICS_DEFAULT_CAPACITY);
+    context->report = diagnostics_report;
+    context->report_arg = &diagnostics;
+    
+    (assemble within the context)
+    
+    diagnostics_print(&diagnostics, stderr);
+    diagnostics_destroy(&diagnostics);
+ */
+
+#ifndef _DIAGNOSTICS_H_
+#define _DIAGNOSTICS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+
+/* Number of errors collected when no maximum is given */
+#define DIAGNOSTICS_DEFAULT_CAPACITY 100
+
+/*
+ * A diagnostic struct contains the following fields:
+ * - type: Error type.
+ * - line_number: Line number at which the error occurred, or 0 if there is none.
+ * - order: Number of errors collected before it, which keeps the sort stable.
+ * - message: Error message, truncated to fit.
+ */
+typedef struct
+{
+    error_t type;
+    int line_number;
+    int order;
+    char message[ERROR_MESSAGE_SIZE];
+} diagnostic_t;
+
+/*
+ * A diagnostics struct contains the following fields:
+ * - entries: Errors collected, allocated up front.
+ * - count: Number of errors collected.
+ * - capacity: Maximum number of errors collected. The assembly stops at the next error.
+ * - is_truncated: Whether an error was left out because the buffer was full, which stopped
+ *                 the assembly.
+ */
+typedef struct
+{
+    diagnostic_t *entries;
+    int count;
+    int capacity;
+    int is_truncated;
+} diagnostics_t;
+
+int diagnostics_init(diagnostics_t *diagnostics, int capacity);
+void diagnostics_destroy(diagnostics_t *diagnostics);
+int diagnostics_report(void *diagnostics, int type, int line_number, const char *message);
+void diagnostics_sort(diagnostics_t *diagnostics);
+int diagnostics_compare(const void *first, const void *second);
+void diagnostics_print(diagnostics_t *diagnostics, FILE *err);
+
+#endif /* _DIAGNOSTICS_H_ */
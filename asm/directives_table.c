@@ -4,33 +4,57 @@
  * @author Lucas de Levy Oliveira
  * @date   06/04/2014
  *
- * @brief  Implements the initialization of the directives table, which holds the names of
- * all valid directives.
+ * @brief  Implements the directives table, which holds the names of all valid directives.
  */
 
 #include "directives_table.h"
 
-/**
- * Init a directives table with the hardcoded directives.
- * @param directives_table a table pointer to store all directives.
- */
-void directives_table_init(hash_table_t *directives_table)
+/* Hardcoded directive names, indexed by directive */
+static const char *directives[] =
 {
-    hash_create(directives_table, "Directives");
-    directives_table_add(directives_table, "SPACE");
-    directives_table_add(directives_table, "CONST");
-    directives_table_add(directives_table, "SECTION");
-}
+    "",
+    "SPACE",
+    "CONST",
+    "SECTION",
+    "EQU",
+    "IF"
+};
 
 /**
- * Add a new directive to the directives table.
- * @param directives_table a table pointer to a already initialised hash table.
- * @param label instruction label string.
- * @param size instruction size in memory, in words.
+ * Map a directive name to its directive. The length and first character of the name are
+ * enough to select a single candidate, which is then confirmed by comparing the whole
+ * name.
+ * @param token directive name, which does not need to be null-terminated.
+ * @param length number of characters of the directive name.
+ * @return the directive or DIRECTIVE_NONE if the token is not a valid directive.
  */
-void directives_table_add(hash_table_t *directives_table, char *label)
+directive_t directives_table_search(const char *token, int length)
 {
-    directive_t *directive = malloc(sizeof(directive_t));
+    directive_t directive = DIRECTIVE_NONE;
     
-    hash_insert(directives_table, label, directive);
-}
\ No newline at end of file
+    switch (length)
+    {
+        case 2:
+            directive = DIRECTIVE_IF;
+            break;
+        case 3:
+            directive = DIRECTIVE_EQU;
+            break;
+        case 5:
+            switch (token[0])
+            {
+                case 'S': directive = DIRECTIVE_SPACE; break;
+                case 'C': directive = DIRECTIVE_CONST; break;
+            }
+            break;
+        case 7:
+            directive = DIRECTIVE_SECTION;
+            break;
+    }
+    
+    if ((directive != DIRECTIVE_NONE) &&
+        (memcmp(directives[directive], token, length) != 0))
+        return DIRECTIVE_NONE;
+    
+    return directive;
+}
@@ -5,21 +5,30 @@
  * @date   06/04/2014
  *
  * @brief  Declares the directives table
+ *
+ * Directive names are classified without any allocation, in the same way as the
+ * instructions mnemonics.
  */
 
 #ifndef _DIRECTIVES_TABLE_H_
 #define _DIRECTIVES_TABLE_H_
 
-#include "hash_table.h"
+#include <string.h>
 
 /**
- * Boilerplate for directives table.
+ * All directives, both the ones evaluated by the assembler (SPACE, CONST and SECTION) and
+ * the ones evaluated by the preprocessor (EQU and IF).
  */
-typedef struct
+typedef enum
 {
+    DIRECTIVE_NONE,
+    DIRECTIVE_SPACE,
+    DIRECTIVE_CONST,
+    DIRECTIVE_SECTION,
+    DIRECTIVE_EQU,
+    DIRECTIVE_IF
 } directive_t;
 
-void directives_table_init(hash_table_t *directives_table);
-void directives_table_add(hash_table_t *directives_table, char *label);
+directive_t directives_table_search(const char *token, int length);
 
-#endif /* _DIRECTIVES_TABLE_H_ */
\ No newline at end of file
+#endif /* _DIRECTIVES_TABLE_H_ */
@@ -6,24 +6,24 @@
  *
  * @brief  Implements elements routines
  *
- * All fields in the element struct is implemented as a string of constant length. To make
- * comparisons easier, strings are said to be empty when the first character is '\0'.
+ * All fields in the element struct are spans over the scanned line. A field is said to be
+ * empty when its span has no characters.
  *
- * Example: element_has_label(el) returns 0 if the label is '\0abc' and 1 if it is 'abc'
+ * Example: element_has_label(el) returns 0 for the line "ADD X" and 1 for "L: ADD X"
  */
 
 #include "elements.h"
 
 /**
- * Init all elements fields with '\0'
+ * Init all elements fields as empty spans
  * @param el element pointer.
  */
 void element_init(element_t *el)
 {
-    el->label[0] = '\0';
-    el->operation[0] = '\0';
-    el->operand1[0] = '\0';
-    el->operand2[0] = '\0';
+    span_init(&el->label);
+    span_init(&el->operation);
+    span_init(&el->operand1);
+    span_init(&el->operand2);
 }
 
 /**
@@ -32,10 +32,10 @@ void element_init(element_t *el)
  */
 void element_clear(element_t *el)
 {
-    el->label[0] = '\0';
-    el->operation[0] = '\0';
-    el->operand1[0] = '\0';
-    el->operand2[0] = '\0';
+    span_init(&el->label);
+    span_init(&el->operation);
+    span_init(&el->operand1);
+    span_init(&el->operand2);
 }
 
 /**
@@ -62,7 +62,7 @@ int element_count_operands(element_t *el)
  */
 int element_has_label(element_t *el)
 {
-    return (el->label[0] != '\0');
+    return !span_is_empty(&el->label);
 }
 
 /**
@@ -72,7 +72,7 @@ int element_has_label(element_t *el)
  */
 int element_has_operation(element_t *el)
 {
-    return (el->operation[0] != '\0');
+    return !span_is_empty(&el->operation);
 }
 
 /**
@@ -82,7 +82,7 @@ int element_has_operation(element_t *el)
  */
 int element_has_operand1(element_t *el)
 {
-    return (el->operand1[0] != '\0');
+    return !span_is_empty(&el->operand1);
 }
 
 /**
@@ -92,5 +92,18 @@ int element_has_operand1(element_t *el)
  */
 int element_has_operand2(element_t *el)
 {
-    return (el->operand2[0] != '\0');
+    return !span_is_empty(&el->operand2);
+}
+
+/**
+ * Print all fields of an element in columns of 15 characters, truncating longer fields.
+ * @param el element pointer.
+ */
+void element_print(element_t *el)
+{
+    context_printf("%15.*s | %15.*s | %15.*s | %15.*s\n",
+           ELEMENT_PRINT_WIDTH(&el->label), el->label.ptr,
+           ELEMENT_PRINT_WIDTH(&el->operation), el->operation.ptr,
+           ELEMENT_PRINT_WIDTH(&el->operand1), el->operand1.ptr,
+           ELEMENT_PRINT_WIDTH(&el->operand2), el->operand2.ptr);
 }
\ No newline at end of file
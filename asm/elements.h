@@ -8,19 +8,29 @@
  *
  * Elements are the basic structure for each line of the pseudo-assembly language. It
  * stores all possible elements of a line: label, operation, and operands.
+ *
+ * Each element is a span over the scanned line, so the line must not change while its
+ * elements are in use.
  */
 
 #ifndef _ELEMENTS_H_
 #define _ELEMENTS_H_
 
-#define ELEMENT_MAX_SIZE 100
+#include <stdio.h>
+#include "span.h"
+#include "context.h"
+
+/* Number of characters printed for each field, longer fields are truncated */
+#define ELEMENT_PRINT_SIZE 15
+#define ELEMENT_PRINT_WIDTH(span) \
+    (((span)->length < ELEMENT_PRINT_SIZE) ? (span)->length : ELEMENT_PRINT_SIZE)
 
 typedef struct
 {
-    char label[ELEMENT_MAX_SIZE];
-    char operation[ELEMENT_MAX_SIZE];
-    char operand1[ELEMENT_MAX_SIZE];
-    char operand2[ELEMENT_MAX_SIZE];
+    span_t label;
+    span_t operation;
+    span_t operand1;
+    span_t operand2;
 } element_t;
 
 void element_init(element_t *el);
@@ -30,5 +40,6 @@ int element_has_label(element_t *el);
 int element_has_operation(element_t *el);
 int element_has_operand1(element_t *el);
 int element_has_operand2(element_t *el);
+void element_print(element_t *el);
 
 #endif /* _ELEMENTS_H_ */
\ No newline at end of file
@@ -4,7 +4,7 @@
  * @author Lucas de Levy Oliveira
  * @date   18/04/2014
  *
- * @brief  Implements the initialization of the equate directives table
+ * @brief  Implements the equate directives table
  */
 
 #include "equate_table.h"
@@ -13,21 +13,60 @@
  * Init a equate directive table
  * @param equate_table a table pointer to store all directives.
  */
-void equate_table_init(hash_table_t *equate_table)
+void equate_table_init(equate_table_t *equate_table)
 {
-    hash_create(equate_table, "Equate directives");
+    equate_table->capacity = EQUATE_TABLE_INITIAL_CAPACITY;
+    equate_table->equates = calloc(equate_table->capacity, sizeof(equate_t));
+}
+
+/**
+ * Free the equates of a equate directives table.
+ * @param equate_table A table pointer to a already initialised table.
+ */
+void equate_table_destroy(equate_table_t *equate_table)
+{
+    free(equate_table->equates);
+    equate_table->equates = NULL;
+    equate_table->capacity = 0;
 }
 
 /**
  * Add a new equate declaration to the equate directives table.
- * @param equate_table A table pointer to a already initialised hash table.
- * @param label Instruction label string.
- * @param value Corresponding value of the equate.
+ * @param equate_table A table pointer to a already initialised table.
+ * @param label Interned id of the equate label.
+ * @param value Token with the corresponding value of the equate. Its characters are not
+ *              copied, and must be valid while the table is used.
  */
-void equate_table_add(hash_table_t *equate_table, char *label, char *value)
+void equate_table_add(equate_table_t *equate_table, int label, const span_t *value)
 {
-    equate_t *equate = malloc(sizeof(equate_t));
+    int capacity = equate_table->capacity;
+    
+    if (label >= capacity)
+    {
+        while (label >= capacity)
+            capacity *= 2;
+        
+        equate_table->equates = realloc(equate_table->equates, sizeof(equate_t)*capacity);
+        memset(&equate_table->equates[equate_table->capacity], 0,
+               sizeof(equate_t)*(capacity - equate_table->capacity));
+        equate_table->capacity = capacity;
+    }
     
-    strcpy(equate->value, value);
-    hash_insert(equate_table, label, equate);
-}
\ No newline at end of file
+    equate_table->equates[label].defined = 1;
+    equate_table->equates[label].value = *value;
+}
+
+/**
+ * Look for the equate of a label.
+ * @param equate_table A table pointer to a already initialised table.
+ * @param label Interned id of the equate label.
+ * @return pointer to the equate or NULL if the label is not an equate.
+ */
+equate_t* equate_table_search(equate_table_t *equate_table, int label)
+{
+    if ((label < 0) || (label >= equate_table->capacity) ||
+        !equate_table->equates[label].defined)
+        return NULL;
+    
+    return &equate_table->equates[label];
+}
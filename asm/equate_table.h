@@ -5,21 +5,37 @@
  * @date   18/04/2014
  *
  * @brief  Declares the equate directives table
+ *
+ * The table is indexed by the interned id of the equate label. The value of an equate is
+ * the token scanned from its EQU directive, so substituting a label is replacing a token
+ * by another, and IF directives read the numeric value of the token without scanning it
+ * again.
  */
 
 #ifndef _EQU_TABLE_H_
 #define _EQU_TABLE_H_
 
-#include "hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include "span.h"
 
-#define EQUATE_VALUE_SIZE 100
+#define EQUATE_TABLE_INITIAL_CAPACITY 64
 
 typedef struct
 {
-    char value[EQUATE_VALUE_SIZE];
+    int defined;
+    span_t value;
 } equate_t;
 
-void equate_table_init(hash_table_t *equate_table);
-void equate_table_add(hash_table_t *equate_table, char *label, char *value);
+typedef struct
+{
+    equate_t *equates;
+    int capacity;
+} equate_table_t;
+
+void equate_table_init(equate_table_t *equate_table);
+void equate_table_destroy(equate_table_t *equate_table);
+void equate_table_add(equate_table_t *equate_table, int label, const span_t *value);
+equate_t* equate_table_search(equate_table_t *equate_table, int label);
 
-#endif /* _EQU_TABLE_H_ */
\ No newline at end of file
+#endif /* _EQU_TABLE_H_ */
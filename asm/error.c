@@ -11,7 +11,8 @@
 
 /**
  * Print an error message with proper format and exit the execution of the program with
- * the defined error type number.
+ * the defined error type number. Within an assembly context, the message goes to its
+ * error stream and the assembly is stopped instead.
  * @param error_type Error type id number.
  * @param format Error message to output on the screen.
  */
@@ -19,72 +20,117 @@ void error(error_t error_type, const char* format, ...)
 {
     va_list args;
     
-    fprintf(stderr, "ERROR [");
-    print_error_type(error_type);
-    fprintf(stderr, "] ");
-    
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    error_print(error_type, 0, format, args);
     va_end(args);
-    fprintf(stderr, "\n");
     
-    exit(error_type);
+    context_fail(error_type);
 }
 
 /**
  * Print an error message with proper format, including the line number and exit the
- * execution of the program with the defined error type number.
+ * execution of the program with the defined error type number. Within an assembly
+ * context, the message goes to its error stream and the assembly is stopped instead,
+ * unless its report routine lets the assembly keep going.
  * @param error_type Error type id number.
- * @param line_number Line number at which the error occurred.
+ * @param line_number Line number at which the error occurred, or 0 if it refers to the
+ *                    whole source code.
  * @param format Error message to output on the screen.
  */
 void error_at_line(error_t error_type, int line_number, const char* format, ...)
 {
     va_list args;
-    
-    fprintf(stderr, "ERROR [");
-    print_error_type(error_type);
-    fprintf(stderr, "] line %d: ", line_number);
+    int is_going;
     
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    is_going = error_print(error_type, line_number, format, args);
     va_end(args);
-    fprintf(stderr, "\n");
     
-    exit(error_type);
+    if (!is_going)
+        context_fail(error_type);
+}
+
+/**
+ * Print an error message with proper format to the error stream of the calling thread. If
+ * its assembly context has a report routine, the message is handed to it instead, and the
+ * error is kept as the status of the context if it is the first one.
+ * @param error_type Error type id number.
+ * @param line_number Line number at which the error occurred, or 0 if there is none.
+ * @param format Error message to output on the screen.
+ * @param args Arguments of the format.
+ * @return 1 if the report routine lets the assembly keep going or 0 otherwise.
+ */
+int error_print(error_t error_type, int line_number, const char* format, va_list args)
+{
+    context_t *context = context_current();
+    FILE *err = context_err();
+    char message[ERROR_MESSAGE_SIZE];
+    
+    if (context && context->report)
+    {
+        vsnprintf(message, sizeof(message), format, args);
+        
+        if (!context->status)
+            context->status = error_type;
+        
+        return context->report(context->report_arg, error_type, line_number, message);
+    }
+    
+    print_error_prefix(err, error_type, line_number);
+    vfprintf(err, format, args);
+    fprintf(err, "\n");
+    
+    return 0;
+}
+
+/**
+ * Print the beginning of an error message, with the error type and the line number.
+ * @param err Stream for error messages.
+ * @param error_type Error type id number.
+ * @param line_number Line number at which the error occurred, or 0 if there is none.
+ */
+void print_error_prefix(FILE *err, error_t error_type, int line_number)
+{
+    fprintf(err, "ERROR [");
+    print_error_type(err, error_type);
+    fprintf(err, "] ");
+    
+    if (line_number > 0)
+        fprintf(err, "line %d: ", line_number);
 }
 
 /**
  * Print error type name on the screen.
+ * @param err Stream for error messages.
  * @param error_type Error type id number.
  */
-void print_error_type(error_t error_type)
+void print_error_type(FILE *err, error_t error_type)
 {
     switch (error_type)
     {
         case ERROR_COMMAND_LINE:
-            fprintf(stderr, "command line");
+            fprintf(err, "command line");
             break;
         case ERROR_FILE:
-            fprintf(stderr, "file");
+            fprintf(err, "file");
             break;
         case ERROR_OBJECT_FILE:
-            fprintf(stderr, "object file");
-            break;
-        case ERROR_LINKED_LIST:
-            fprintf(stderr, "linked list");
+            fprintf(err, "object file");
             break;
         case ERROR_SCANNER:
-            fprintf(stderr, "scanner");
+            fprintf(err, "scanner");
             break;
         case ERROR_LEXICAL:
-            fprintf(stderr, "lexical");
+            fprintf(err, "lexical");
             break;
         case ERROR_SYNTACTIC:
-            fprintf(stderr, "syntactic");
+            fprintf(err, "syntactic");
             break;
         case ERROR_SEMANTIC:
-            fprintf(stderr, "semantic");
+            fprintf(err, "semantic");
+            break;
+        case ERROR_THREAD:
+            fprintf(err, "thread");
             break;
     }
 }
\ No newline at end of file
@@ -16,21 +16,28 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include "context.h"
+
+/* Maximum length of an error message handed to a report routine */
+#define ERROR_MESSAGE_SIZE 512
 
 typedef enum
 {
     ERROR_COMMAND_LINE=1,
     ERROR_FILE,
     ERROR_OBJECT_FILE,
-    ERROR_LINKED_LIST,
-    ERROR_SCANNER,
+    /* 4 was the linked list error, which is no longer used, and stays reserved */
+    ERROR_SCANNER=5,
     ERROR_LEXICAL,
     ERROR_SYNTACTIC,
     ERROR_SEMANTIC,
+    ERROR_THREAD,
 } error_t;
 
 void error(error_t error_type, const char* format, ...);
 void error_at_line(error_t error_type, int line_number, const char* format, ...);
-void print_error_type(error_t error_type);
+int error_print(error_t error_type, int line_number, const char* format, va_list args);
+void print_error_prefix(FILE *err, error_t error_type, int line_number);
+void print_error_type(FILE *err, error_t error_type);
 
 #endif /* _ERROR_H_ */
\ No newline at end of file
@@ -4,47 +4,102 @@
  * @author Lucas de Levy Oliveira
  * @date   06/04/2014
  *
- * @brief  Implements the initialization of the instructions and opcodes tables
+ * @brief  Implements the instructions and opcodes tables
  */
 
 #include "instructions_table.h"
 
+/* Hardcoded instructions, indexed by opcode */
+static const instruction_t instructions[] =
+{
+    {"",       0, NO_OPCODE},
+    {"ADD",    2, ADD_OPCODE},
+    {"SUB",    2, SUB_OPCODE},
+    {"MULT",   2, MULT_OPCODE},
+    {"DIV",    2, DIV_OPCODE},
+    {"JMP",    2, JMP_OPCODE},
+    {"JMPN",   2, JMPN_OPCODE},
+    {"JMPP",   2, JMPP_OPCODE},
+    {"JMPZ",   2, JMPZ_OPCODE},
+    {"COPY",   3, COPY_OPCODE},
+    {"LOAD",   2, LOAD_OPCODE},
+    {"STORE",  2, STORE_OPCODE},
+    {"INPUT",  2, INPUT_OPCODE},
+    {"OUTPUT", 2, OUTPUT_OPCODE},
+    {"STOP",   1, STOP_OPCODE}
+};
+
 /**
- * Init a instructions table with the hardcoded instructions.
- * @param instructions_table a table pointer to store all instructions.
+ * Look for an instruction in the instructions table.
+ * @param token instruction name, which does not need to be null-terminated.
+ * @param length number of characters of the instruction name.
+ * @return pointer to the instruction or NULL if the token is not a valid instruction.
  */
-void instructions_table_init(hash_table_t *instructions_table)
+const instruction_t* instructions_table_search(const char *token, int length)
 {
-    hash_create(instructions_table, "Instructions");
-    instructions_table_add(instructions_table, "ADD", 2, ADD_OPCODE);
-    instructions_table_add(instructions_table, "SUB", 2, SUB_OPCODE);
-    instructions_table_add(instructions_table, "MULT", 2, MULT_OPCODE);
-    instructions_table_add(instructions_table, "DIV", 2, DIV_OPCODE);
-    instructions_table_add(instructions_table, "JMP", 2, JMP_OPCODE);
-    instructions_table_add(instructions_table, "JMPN", 2, JMPN_OPCODE);
-    instructions_table_add(instructions_table, "JMPP", 2, JMPP_OPCODE);
-    instructions_table_add(instructions_table, "JMPZ", 2, JMPZ_OPCODE);
-    instructions_table_add(instructions_table, "COPY", 3, COPY_OPCODE);
-    instructions_table_add(instructions_table, "LOAD", 2, LOAD_OPCODE);
-    instructions_table_add(instructions_table, "STORE", 2, STORE_OPCODE);
-    instructions_table_add(instructions_table, "INPUT", 2, INPUT_OPCODE);
-    instructions_table_add(instructions_table, "OUTPUT", 2, OUTPUT_OPCODE);
-    instructions_table_add(instructions_table, "STOP", 1, STOP_OPCODE);
+    opcode_t opcode = instructions_table_classify(token, length);
+    
+    if (opcode == NO_OPCODE)
+        return NULL;
+    
+    return &instructions[opcode];
 }
 
 /**
- * Add a new instruction to the instructions table.
- * @param instructions_table a table pointer to a already initialised hash table.
- * @param label instruction label string.
- * @param size instruction size in memory, in words.
- * @param opcode instruction opcode number.
+ * Map an instruction name to its opcode. The length and first character of the name (or
+ * the last one, for the conditional jumps) are enough to select a single candidate, which
+ * is then confirmed by comparing the whole name.
+ * @param token instruction name, which does not need to be null-terminated.
+ * @param length number of characters of the instruction name.
+ * @return the instruction opcode or NO_OPCODE if the token is not a valid instruction.
  */
-void instructions_table_add(hash_table_t *instructions_table, char *label, int size,
-                            int opcode)
+opcode_t instructions_table_classify(const char *token, int length)
 {
-    instruction_t *instruction = malloc(sizeof(instruction_t));
+    opcode_t opcode = NO_OPCODE;
     
-    instruction->size = size;
-    instruction->opcode = opcode;
-    hash_insert(instructions_table, label, instruction);
-}
\ No newline at end of file
+    switch (length)
+    {
+        case 3:
+            switch (token[0])
+            {
+                case 'A': opcode = ADD_OPCODE; break;
+                case 'S': opcode = SUB_OPCODE; break;
+                case 'D': opcode = DIV_OPCODE; break;
+                case 'J': opcode = JMP_OPCODE; break;
+            }
+            break;
+        case 4:
+            switch (token[0])
+            {
+                case 'M': opcode = MULT_OPCODE; break;
+                case 'C': opcode = COPY_OPCODE; break;
+                case 'L': opcode = LOAD_OPCODE; break;
+                case 'S': opcode = STOP_OPCODE; break;
+                case 'J':
+                    switch (token[3])
+                    {
+                        case 'N': opcode = JMPN_OPCODE; break;
+                        case 'P': opcode = JMPP_OPCODE; break;
+                        case 'Z': opcode = JMPZ_OPCODE; break;
+                    }
+                    break;
+            }
+            break;
+        case 5:
+            switch (token[0])
+            {
+                case 'S': opcode = STORE_OPCODE; break;
+                case 'I': opcode = INPUT_OPCODE; break;
+            }
+            break;
+        case 6:
+            if (token[0] == 'O')
+                opcode = OUTPUT_OPCODE;
+            break;
+    }
+    
+    if ((opcode != NO_OPCODE) && (memcmp(instructions[opcode].name, token, length) != 0))
+        return NO_OPCODE;
+    
+    return opcode;
+}
@@ -5,36 +5,44 @@
  * @date   06/04/2014
  *
  * @brief  Declares the instructions and the opcodes tables
+ *
+ * The instructions table is a constant array indexed by opcode. Mnemonics are classified
+ * without any allocation by switching on their length and characters, and confirming the
+ * match with a single comparison.
  */
 
 #ifndef _INSTRUCTIONS_TABLE_H_
 #define _INSTRUCTIONS_TABLE_H_
 
-#include "hash_table.h"
+#include <string.h>
 
-#define ADD_OPCODE 0x1
-#define SUB_OPCODE 0x2
-#define MULT_OPCODE 0x3
-#define DIV_OPCODE 0x4
-#define JMP_OPCODE 0x5
-#define JMPN_OPCODE 0x6
-#define JMPP_OPCODE 0x7
-#define JMPZ_OPCODE 0x8
-#define COPY_OPCODE 0x9
-#define LOAD_OPCODE 0xA
-#define STORE_OPCODE 0xB
-#define INPUT_OPCODE 0xC
-#define OUTPUT_OPCODE 0xD
-#define STOP_OPCODE 0xE
+typedef enum
+{
+    NO_OPCODE = 0x0,
+    ADD_OPCODE = 0x1,
+    SUB_OPCODE = 0x2,
+    MULT_OPCODE = 0x3,
+    DIV_OPCODE = 0x4,
+    JMP_OPCODE = 0x5,
+    JMPN_OPCODE = 0x6,
+    JMPP_OPCODE = 0x7,
+    JMPZ_OPCODE = 0x8,
+    COPY_OPCODE = 0x9,
+    LOAD_OPCODE = 0xA,
+    STORE_OPCODE = 0xB,
+    INPUT_OPCODE = 0xC,
+    OUTPUT_OPCODE = 0xD,
+    STOP_OPCODE = 0xE
+} opcode_t;
 
 typedef struct
 {
+    char *name;
     int size;
-    int opcode;
+    opcode_t opcode;
 } instruction_t;
 
-void instructions_table_init(hash_table_t *instructions_table);
-void instructions_table_add(hash_table_t *instructions_table, char *label, int size,
-                            int opcode);
+const instruction_t* instructions_table_search(const char *token, int length);
+opcode_t instructions_table_classify(const char *token, int length);
 
-#endif /* _INSTRUCTIONS_TABLE_H_ */
\ No newline at end of file
+#endif /* _INSTRUCTIONS_TABLE_H_ */
@@ -0,0 +1,216 @@
+/**
+ * @file   interner.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the string interner
+ *
+ * Strings are bump allocated from an arena and never freed individually. The index is
+ * an open addressing table with linear probing, the only one in the assembler, kept below
+ * half full so probing sequences stay short.
+ */
+
+#include "interner.h"
+
+/**
+ * Initialise an empty interner, whose strings are stored in its own arena.
+ * @param interner pointer for the previously allocated interner.
+ */
+void interner_init(interner_t *interner)
+{
+    interner_init_in_arena(interner, NULL);
+}
+
+/**
+ * Initialise an empty interner whose strings are allocated from a given arena, which
+ * outlives the interner and releases the strings itself.
+ * @param interner pointer for the previously allocated interner.
+ * @param arena pointer for the previously initialised arena, or NULL for the interner's
+ *              own arena.
+ */
+void interner_init_in_arena(interner_t *interner, arena_t *arena)
+{
+    arena_init(&interner->own_arena);
+    interner->arena = arena ? arena : &interner->own_arena;
+    
+    interner->count = 0;
+    interner->capacity = INTERNER_INITIAL_CAPACITY;
+    interner->strings = malloc(sizeof(char*)*interner->capacity);
+    interner->lengths = malloc(sizeof(int)*interner->capacity);
+    interner->hashes = malloc(sizeof(unsigned int)*interner->capacity);
+    
+    interner->index_capacity = 2*INTERNER_INITIAL_CAPACITY;
+    interner->index = calloc(interner->index_capacity, sizeof(int));
+}
+
+/**
+ * Free all interned strings and the interner arrays. Strings allocated from an arena
+ * given to interner_init_in_arena are left to it.
+ * @param interner pointer for the previously initialised interner.
+ */
+void interner_destroy(interner_t *interner)
+{
+    arena_destroy(&interner->own_arena);
+    free(interner->strings);
+    free(interner->lengths);
+    free(interner->hashes);
+    free(interner->index);
+    interner->count = 0;
+}
+
+/**
+ * Get the id of a string, storing it in the interner if it was never seen before.
+ * @param interner pointer for the previously initialised interner.
+ * @param str characters of the string, which do not need to be null-terminated.
+ * @param length number of characters of the string.
+ * @return the string id.
+ */
+int interner_intern(interner_t *interner, const char *str, int length)
+{
+    unsigned int hash = interner_hash(str, length);
+    int *position = interner_probe(interner, str, length, hash);
+    int id;
+    
+    if (*position != 0)
+        return *position - 1;
+    
+    /* New string: make room for its id and keep the index at most half full */
+    if (interner->count == interner->capacity)
+    {
+        interner->capacity *= 2;
+        interner->strings = realloc(interner->strings,
+                                    sizeof(char*)*interner->capacity);
+        interner->lengths = realloc(interner->lengths, sizeof(int)*interner->capacity);
+        interner->hashes = realloc(interner->hashes,
+                                   sizeof(unsigned int)*interner->capacity);
+    }
+    
+    if (2*(interner->count + 1) > interner->index_capacity)
+    {
+        interner_grow_index(interner);
+        position = interner_probe(interner, str, length, hash);
+    }
+    
+    id = interner->count++;
+    interner->strings[id] = arena_alloc(interner->arena, length + 1);
+    memcpy(interner->strings[id], str, length);
+    interner->strings[id][length] = '\0';
+    interner->lengths[id] = length;
+    interner->hashes[id] = hash;
+    *position = id + 1;
+    
+    return id;
+}
+
+/**
+ * Get the id of a string without storing it.
+ * @param interner pointer for the previously initialised interner.
+ * @param str characters of the string, which do not need to be null-terminated.
+ * @param length number of characters of the string.
+ * @return the string id or INTERNER_NOT_FOUND if it was never interned.
+ */
+int interner_find(interner_t *interner, const char *str, int length)
+{
+    int *position = interner_probe(interner, str, length, interner_hash(str, length));
+    
+    if (*position != 0)
+        return *position - 1;
+    
+    return INTERNER_NOT_FOUND;
+}
+
+/**
+ * Get the null-terminated string of an id. The pointer is valid until the interner is
+ * destroyed.
+ * @param interner pointer for the previously initialised interner.
+ * @param id string id, as returned by interner_intern.
+ * @return the interned string.
+ */
+char* interner_string(interner_t *interner, int id)
+{
+    return interner->strings[id];
+}
+
+/**
+ * Return the number of distinct strings in the interner, which is also the smallest id
+ * not used yet.
+ * @param interner pointer for the previously initialised interner.
+ * @return number of interned strings.
+ */
+int interner_count(interner_t *interner)
+{
+    return interner->count;
+}
+
+/**
+ * Calculate the hash of a string, multiplying by 31 for each character, followed by a mix
+ * of the high bits into the low ones.
+ * @param str characters of the string.
+ * @param length number of characters of the string.
+ * @return the hash value, which must be bounded by the caller.
+ */
+unsigned int interner_hash(const char *str, int length)
+{
+    unsigned int hash_value = 0;
+    int i;
+    
+    for (i = 0; i < length; ++i)
+        hash_value = (unsigned int)str[i] + (hash_value << 5) - hash_value;
+    
+    hash_value ^= hash_value >> 16;
+    hash_value *= 0x45d9f3b;
+    hash_value ^= hash_value >> 16;
+    
+    return hash_value;
+}
+
+/**
+ * Find the index position holding a string or, if the string is not interned, the empty
+ * position where its id should be stored.
+ * @param interner pointer for the previously initialised interner.
+ * @param str characters of the string.
+ * @param length number of characters of the string.
+ * @param hash hash value of the string, as returned by interner_hash.
+ * @return pointer to the index position.
+ */
+int* interner_probe(interner_t *interner, const char *str, int length, unsigned int hash)
+{
+    unsigned int mask = interner->index_capacity - 1;
+    unsigned int i = hash & mask;
+    int id;
+    
+    while (interner->index[i] != 0)
+    {
+        id = interner->index[i] - 1;
+        
+        if ((interner->hashes[id] == hash) && (interner->lengths[id] == length) &&
+            (memcmp(interner->strings[id], str, length) == 0))
+            break;
+        
+        i = (i + 1) & mask;
+    }
+    
+    return &interner->index[i];
+}
+
+/**
+ * Double the index capacity, placing every id at its new position.
+ * @param interner pointer for the previously initialised interner.
+ */
+void interner_grow_index(interner_t *interner)
+{
+    unsigned int mask;
+    unsigned int i;
+    int id;
+    
+    free(interner->index);
+    interner->index_capacity *= 2;
+    interner->index = calloc(interner->index_capacity, sizeof(int));
+    mask = interner->index_capacity - 1;
+    
+    for (id = 0; id < interner->count; ++id)
+    {
+        for (i = interner->hashes[id] & mask; interner->index[i] != 0; i = (i + 1) & mask);
+        interner->index[i] = id + 1;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file   interner.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the string interner
+ *
+ * The interner stores each distinct identifier only once and gives it a dense integer id,
+ * starting at zero. Tables keyed by identifiers can then be plain arrays indexed by id,
+ * and comparing two identifiers is comparing two integers.
+ *
+ * Example usage
+ *
+    interner_t interner;
+    int id;
+    
+    interner_init(&interner);
+    id = interner_intern(&interner, "LABEL", 5);
+    
+    if (interner_intern(&interner, "LABEL", 5) == id)
+        printf("%s has id %d\n", interner_string(&interner, id), id);
+    
+    interner_destroy(&interner);
+ */
+
+#ifndef _INTERNER_H_
+#define _INTERNER_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define INTERNER_NOT_FOUND -1
+
+/* Must be a power of two, since probing masks the hash with (capacity - 1) */
+#define INTERNER_INITIAL_CAPACITY 64
+
+/*
+ * Strings are stored, null-terminated, in the arena, which is either own_arena or an arena
+ * lent by the owner of the interner. The arrays strings, lengths and
+ * hashes are indexed by id. The index is an open addressing table holding id + 1 for
+ * each used position and 0 for the empty ones.
+ */
+typedef struct
+{
+    arena_t *arena;
+    arena_t own_arena;
+    char **strings;
+    int *lengths;
+    unsigned int *hashes;
+    int count;
+    int capacity;
+    int *index;
+    int index_capacity;
+} interner_t;
+
+void interner_init(interner_t *interner);
+void interner_init_in_arena(interner_t *interner, arena_t *arena);
+void interner_destroy(interner_t *interner);
+int interner_intern(interner_t *interner, const char *str, int length);
+int interner_find(interner_t *interner, const char *str, int length);
+char* interner_string(interner_t *interner, int id);
+int interner_count(interner_t *interner);
+unsigned int interner_hash(const char *str, int length);
+int* interner_probe(interner_t *interner, const char *str, int length, unsigned int hash);
+void interner_grow_index(interner_t *interner);
+
+#endif /* _INTERNER_H_ */
@@ -0,0 +1,256 @@
+/**
+ * @file   listing.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the assembly listing
+ *
+ * Lines are assembled in address order, so their words are read back from the object
+ * file a window at a time, which only touches the output file again once per window when
+ * the object file is streamed.
+ */
+
+#include "listing.h"
+
+/**
+ * Init an empty listing.
+ * @param listing Pointer to a listing struct.
+ */
+void listing_init(listing_t *listing)
+{
+    listing->lines = NULL;
+    listing->line_count = 0;
+    listing->line_capacity = 0;
+    listing->references = NULL;
+    listing->reference_count = 0;
+    listing->reference_capacity = 0;
+}
+
+/**
+ * Free the memory used by a listing.
+ * @param listing Pointer to a listing struct.
+ */
+void listing_destroy(listing_t *listing)
+{
+    free(listing->lines);
+    free(listing->references);
+    listing_init(listing);
+}
+
+/**
+ * Record an assembled line.
+ * @param listing Pointer to a listing struct.
+ * @param line Source line, whose characters must be valid until the listing is written.
+ * @param address Address of the first word of the line.
+ * @param size Number of words the line was encoded to.
+ */
+void listing_add_line(listing_t *listing, const source_line_t *line, int address,
+                      int size)
+{
+    listing_line_t *entry;
+    
+    if (listing->line_count == listing->line_capacity)
+    {
+        listing->line_capacity = (listing->line_capacity > 0)
+                                 ? 2*listing->line_capacity
+                                 : LISTING_INITIAL_CAPACITY;
+        listing->lines = realloc(listing->lines,
+                                 sizeof(listing_line_t)*listing->line_capacity);
+        
+        if (!listing->lines)
+            error(ERROR_FILE, "Cannot allocate memory for the listing");
+    }
+    
+    entry = &listing->lines[listing->line_count++];
+    entry->line = *line;
+    entry->address = address;
+    entry->size = size;
+}
+
+/**
+ * Record a label appearing at a line.
+ * @param listing Pointer to a listing struct.
+ * @param symbol Interned id of the label.
+ * @param line_number Line at which it appears.
+ * @param is_definition Whether the line defines the label, instead of using it.
+ */
+void listing_add_reference(listing_t *listing, int symbol, int line_number,
+                           int is_definition)
+{
+    listing_reference_t *reference;
+    
+    if (listing->reference_count == listing->reference_capacity)
+    {
+        listing->reference_capacity = (listing->reference_capacity > 0)
+                                      ? 2*listing->reference_capacity
+                                      : LISTING_INITIAL_CAPACITY;
+        listing->references = realloc(listing->references, sizeof(listing_reference_t)*
+                                      listing->reference_capacity);
+        
+        if (!listing->references)
+            error(ERROR_FILE, "Cannot allocate memory for the listing");
+    }
+    
+    reference = &listing->references[listing->reference_count++];
+    reference->symbol = symbol;
+    reference->line_number = line_number;
+    reference->is_definition = is_definition;
+}
+
+/**
+ * Write the listing of an assembly which succeeded, once every fixup is resolved.
+ * @param listing Pointer to a listing struct.
+ * @param filename Listing file name.
+ * @param object_file Object file of the assembly.
+ * @param symbols_table Table containing all symbols.
+ * @param interner Interner for the label names.
+ */
+void listing_write(listing_t *listing, char *filename, object_file_t *object_file,
+                   symbols_table_t *symbols_table, interner_t *interner)
+{
+    writer_t *writer = writer_open(filename);
+    
+    listing_write_lines(listing, writer, object_file);
+    listing_write_symbols(listing, writer, symbols_table, interner);
+    writer_close(writer);
+}
+
+/**
+ * Write the address, words and source of each line. Only the first words of a line are
+ * shown, which covers every instruction; a '+' marks lines with more of them, as SPACE
+ * directives.
+ * @param listing Pointer to a listing struct.
+ * @param writer Writer of the listing file.
+ * @param object_file Object file of the assembly.
+ */
+void listing_write_lines(listing_t *listing, writer_t *writer,
+                         object_file_t *object_file)
+{
+    obj_t window[LISTING_WINDOW_SIZE];
+    int window_address = 0;
+    int window_size = 0;
+    listing_line_t *entry;
+    int count;
+    int i, j;
+    
+    writer_put_string(writer, LISTING_LINES_HEADER, strlen(LISTING_LINES_HEADER));
+    
+    for (i = 0; i < listing->line_count; ++i)
+    {
+        entry = &listing->lines[i];
+        count = (entry->size < LISTING_WORDS_PER_LINE) ? entry->size
+                                                       : LISTING_WORDS_PER_LINE;
+        
+        /* Lines only move forward, so the window is read again from the line onwards */
+        if (entry->address + count > window_address + window_size)
+        {
+            window_address = entry->address;
+            window_size = object_file->size - window_address;
+            if (window_size > LISTING_WINDOW_SIZE)
+                window_size = LISTING_WINDOW_SIZE;
+            
+            object_file_get_words(object_file, window_address, window, window_size);
+        }
+        
+        writer_put_int(writer, entry->address, LISTING_ADDRESS_WIDTH);
+        writer_put_spaces(writer, 1);
+        
+        for (j = 0; j < count; ++j)
+            writer_put_int(writer, window[entry->address - window_address + j],
+                           LISTING_WORD_WIDTH);
+        
+        writer_put_spaces(writer, (LISTING_WORDS_PER_LINE - count)*LISTING_WORD_WIDTH);
+        writer_put_char(writer, (entry->size > count) ? '+' : ' ');
+        writer_put_int(writer, entry->line.number, LISTING_LINE_WIDTH);
+        writer_put_spaces(writer, 2);
+        writer_put_string(writer, entry->line.ptr, entry->line.length);
+        writer_put_char(writer, '\n');
+    }
+}
+
+/**
+ * Write the cross-reference of every label, in order of first appearance: its value, the
+ * line defining it and every line using it. References are sorted by label, so the ones
+ * of each label are next to each other.
+ * @param listing Pointer to a listing struct.
+ * @param writer Writer of the listing file.
+ * @param symbols_table Table containing all symbols.
+ * @param interner Interner for the label names.
+ */
+void listing_write_symbols(listing_t *listing, writer_t *writer,
+                           symbols_table_t *symbols_table, interner_t *interner)
+{
+    listing_reference_t *reference;
+    symbol_t *symbol_ptr;
+    char *name;
+    int length;
+    int last_line;
+    int i;
+    
+    qsort(listing->references, listing->reference_count, sizeof(listing_reference_t),
+          listing_compare_references);
+    
+    writer_put_string(writer, LISTING_SYMBOLS_HEADER, strlen(LISTING_SYMBOLS_HEADER));
+    
+    for (i = 0; i < listing->reference_count; )
+    {
+        reference = &listing->references[i];
+        symbol_ptr = symbols_table_search(symbols_table, reference->symbol);
+        name = interner_string(interner, reference->symbol);
+        length = strlen(name);
+        
+        writer_put_string(writer, name, length);
+        writer_put_spaces(writer, LISTING_SYMBOL_WIDTH - length);
+        writer_put_int(writer, symbol_ptr ? symbol_ptr->value : 0, LISTING_LINE_WIDTH);
+        
+        /* The definition comes first, since every label is defined once */
+        if (reference->is_definition)
+        {
+            writer_put_int(writer, reference->line_number, LISTING_LINE_WIDTH);
+            ++i;
+        }
+        else
+        {
+            writer_put_spaces(writer, LISTING_LINE_WIDTH);
+        }
+        
+        last_line = 0;
+        
+        for (; (i < listing->reference_count) &&
+               (listing->references[i].symbol == reference->symbol); ++i)
+        {
+            /* A line using the label twice is only listed once */
+            if (listing->references[i].line_number == last_line)
+                continue;
+            
+            writer_put_spaces(writer, last_line ? 1 : 2);
+            last_line = listing->references[i].line_number;
+            writer_put_int(writer, last_line, 0);
+        }
+        
+        writer_put_char(writer, '\n');
+    }
+}
+
+/**
+ * Compare two references by label id, then with definitions first, then by line number.
+ * @param a Pointer to a listing reference.
+ * @param b Pointer to another listing reference.
+ * @return negative, zero or positive as a comes before, with or after b.
+ */
+int listing_compare_references(const void *a, const void *b)
+{
+    const listing_reference_t *first = a;
+    const listing_reference_t *second = b;
+    
+    if (first->symbol != second->symbol)
+        return (first->symbol < second->symbol) ? -1 : 1;
+    
+    if (first->is_definition != second->is_definition)
+        return first->is_definition ? -1 : 1;
+    
+    if (first->line_number != second->line_number)
+        return (first->line_number < second->line_number) ? -1 : 1;
+    
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file   listing.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the assembly listing
+ *
+ * The listing shows, for each assembled line, its address, the words it was encoded to
+ * and the line itself, followed by a cross-reference of every label: its value, the line
+ * defining it and the lines using it. The assembler only records where each line and
+ * label appears while assembling, since words referring to labels defined later are only
+ * known once every fixup is resolved. The listing is written at the end, through a
+ * buffered writer.
+ *
+ * Example usage
+ *
+    listing_t listing;
+    
+    listing_init(&listing);
+    
+    (for each line assembled)
+    source_original_line(&source, &record.line, &original);
+    listing_add_line(&listing, &original, address, object_file.size - address);
+    listing_add_reference(&listing, label_id, record.line.number, 0);
+    
+    listing_write(&listing, "program.lst", &object_file, &symbols_table, &interner);
+    listing_destroy(&listing);
+ */
+
+#ifndef _LISTING_H_
+#define _LISTING_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "source.h"
+#include "object_file.h"
+#include "symbols_table.h"
+#include "interner.h"
+#include "writer.h"
+
+/* Initial capacity of the lines and references arrays */
+#define LISTING_INITIAL_CAPACITY 256
+
+/* Number of words shown for each line, which covers every instruction */
+#define LISTING_WORDS_PER_LINE 3
+
+/* Number of words read back from the object file at once */
+#define LISTING_WINDOW_SIZE 256
+
+/* Width of the columns, in characters */
+#define LISTING_ADDRESS_WIDTH 6
+#define LISTING_WORD_WIDTH 7
+#define LISTING_LINE_WIDTH 7
+#define LISTING_SYMBOL_WIDTH 20
+
+/* Headers of the lines and of the cross-reference, aligned to the columns */
+#define LISTING_LINES_HEADER "  Addr Code                     Line  Source\n"
+#define LISTING_SYMBOLS_HEADER "\nSymbol                Value   Line  References\n"
+
+/*
+ * A listing line struct contains the following fields:
+ * - line: Source line as written, with its comment.
+ * - address: Address of its first word.
+ * - size: Number of words it was encoded to.
+ */
+typedef struct
+{
+    source_line_t line;
+    int address;
+    int size;
+} listing_line_t;
+
+/*
+ * A listing reference struct records a label appearing at a line, either defined there or
+ * used as an operand.
+ */
+typedef struct
+{
+    int symbol;
+    int line_number;
+    int is_definition;
+} listing_reference_t;
+
+/*
+ * A listing struct contains the following fields:
+ * - lines: Every assembled line, in order.
+ * - line_count: Number of lines.
+ * - line_capacity: Number of lines allocated, which grows geometrically.
+ * - references: Every label appearance, in order of line.
+ * - reference_count: Number of references.
+ * - reference_capacity: Number of references allocated, which grows geometrically.
+ */
+typedef struct
+{
+    listing_line_t *lines;
+    int line_count;
+    int line_capacity;
+    listing_reference_t *references;
+    int reference_count;
+    int reference_capacity;
+} listing_t;
+
+void listing_init(listing_t *listing);
+void listing_destroy(listing_t *listing);
+void listing_add_line(listing_t *listing, const source_line_t *line, int address,
+                      int size);
+void listing_add_reference(listing_t *listing, int symbol, int line_number,
+                           int is_definition);
+void listing_write(listing_t *listing, char *filename, object_file_t *object_file,
+                   symbols_table_t *symbols_table, interner_t *interner);
+void listing_write_lines(listing_t *listing, writer_t *writer,
+                         object_file_t *object_file);
+void listing_write_symbols(listing_t *listing, writer_t *writer,
+                           symbols_table_t *symbols_table, interner_t *interner);
+int listing_compare_references(const void *a, const void *b);
+
+#endif /* _LISTING_H_ */
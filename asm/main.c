@@ -8,22 +8,147 @@
  */
 
 #include "assembler.h"
+#include "batch.h"
+#include "cache.h"
 
+/*
+ * Command line options, which come before the file names:
+ * - is_pipelined: Whether --pipeline was given.
+ * - jobs: Number of files assembled at once, given by --jobs, or 0.
+ * - manifest: Manifest file name, given by --manifest, or NULL.
+ * - max_errors: Number of errors after which the assembly stops, given by --max-errors,
+ *               or 0 for stopping at the first one. --keep-going uses a default number.
+ * - listing: Listing file name, given by -l, or NULL.
+ * - cache: Cache directory, given by --cache, or NULL.
+ * - cache_limit: Size limit of the cache in bytes, given by --cache-size in megabytes.
+ * Either --jobs or --manifest assembles every file name given as a batch.
+ */
+typedef struct
+{
+    int is_pipelined;
+    int jobs;
+    char *manifest;
+    int max_errors;
+    char *listing;
+    char *cache;
+    long cache_limit;
+} options_t;
+
+int parse_options(int argc, char **argv, options_t *options);
 void parse_arguments(int argc, char **argv, char **infile, char **prefile, char **outfile);
+int assemble_file(char *infile, char *prefile, char *outfile, options_t *options);
+int assemble_cached(char *infile, char *prefile, char *outfile, options_t *options);
+int assemble_keep_going(char *infile, char *prefile, char *outfile, options_t *options);
+int assemble_batch(int argc, char **argv, options_t *options);
 
 /**
  * Main function. Parse the arguments, preprocess the input file and assemble the
- * preprocessed file, generating an object file.
+ * preprocessed lines, generating an object file. The preprocessed file is only written
+ * when its name is given. With --pipeline, preprocessing runs on another thread while
+ * assembling. With --jobs or --manifest, many files are assembled instead. With
+ * --keep-going or --max-errors, assembling goes on after errors to report them all.
+ * Nothing is printed but errors; with -l, a listing of the assembly is written instead.
+ * With --cache, files which did not change are not assembled again.
  */
 int main(int argc, char **argv)
 {
     char *infile, *prefile, *outfile;
+    options_t options;
+    int first;
+    
+    /* Skip the options, so the file names start at argv[1] */
+    first = parse_options(argc, argv, &options);
+    argc -= first - 1;
+    argv += first - 1;
+    
+    if (options.jobs || options.manifest)
+        return assemble_batch(argc, argv, &options);
     
     parse_arguments(argc, argv, &infile, &prefile, &outfile);
-    preprocess(infile, prefile);
-    assemble(prefile, outfile);
     
-    return 0;
+    if (options.max_errors && options.is_pipelined)
+        error(ERROR_COMMAND_LINE, "--pipeline cannot be used with --keep-going");
+    
+    if (options.cache)
+        return assemble_cached(infile, prefile, outfile, &options);
+    
+    return assemble_file(infile, prefile, outfile, &options);
+}
+
+/**
+ * Get options from command line
+ * @param argc number of arguments
+ * @param argv command line arguments
+ * @param options stores the options given
+ * @return index of the first argument which is not an option
+ */
+int parse_options(int argc, char **argv, options_t *options)
+{
+    char *end;
+    int i;
+    
+    options->is_pipelined = 0;
+    options->jobs = 0;
+    options->manifest = NULL;
+    options->max_errors = 0;
+    options->listing = NULL;
+    options->cache = NULL;
+    options->cache_limit = CACHE_DEFAULT_LIMIT;
+    
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); ++i)
+    {
+        if (strcmp(argv[i], "--pipeline") == 0)
+        {
+            options->is_pipelined = 1;
+        }
+        else if ((strcmp(argv[i], "--jobs") == 0) && (i + 1 < argc))
+        {
+            options->jobs = strtol(argv[++i], &end, 10);
+            
+            if ((*end != '\0') || (options->jobs < 1))
+                error(ERROR_COMMAND_LINE, "Invalid number of jobs %s", argv[i]);
+        }
+        else if ((strcmp(argv[i], "--manifest") == 0) && (i + 1 < argc))
+        {
+            options->manifest = argv[++i];
+        }
+        else if (strcmp(argv[i], "--keep-going") == 0)
+        {
+            if (!options->max_errors)
+                options->max_errors = DIAGNOSTICS_DEFAULT_CAPACITY;
+        }
+        else if ((strcmp(argv[i], "--max-errors") == 0) && (i + 1 < argc))
+        {
+            options->max_errors = strtol(argv[++i], &end, 10);
+            
+            if ((*end != '\0') || (options->max_errors < 1))
+                error(ERROR_COMMAND_LINE, "Invalid number of errors %s", argv[i]);
+        }
+        else if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc))
+        {
+            options->listing = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--cache") == 0) && (i + 1 < argc))
+        {
+            options->cache = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--cache-size") == 0) && (i + 1 < argc))
+        {
+            options->cache_limit = strtol(argv[++i], &end, 10);
+            
+            if ((*end != '\0') || (options->cache_limit < 1) ||
+                (options->cache_limit > LONG_MAX/(1024*1024)))
+                error(ERROR_COMMAND_LINE, "Invalid cache size %s", argv[i]);
+            
+            options->cache_limit *= 1024*1024;
+        }
+        else
+        {
+            error(ERROR_COMMAND_LINE, "Unknown option %s", argv[i]);
+        }
+    }
+    
+    return i;
 }
 
 /**
@@ -31,22 +156,190 @@ int main(int argc, char **argv)
  * @param argc number of arguments
  * @param argv command line arguments
  * @param infile input file name with code in assembly
- * @param prefile output file name for preprocessed code
+ * @param prefile output file name for preprocessed code, or NULL when not given
  * @param outfile output file name for object code
  */
 void parse_arguments(int argc, char **argv, char **infile, char **prefile, char **outfile)
 {
-    if (argc != 4)
+    if ((argc != 3) && (argc != 4))
         error(ERROR_COMMAND_LINE, "Wrong number of arguments\n"
-              "Usage: assembler <input> <preprocessing> <output>");
+              "Usage: assembler [--pipeline] [--keep-going] [--max-errors <n>] "
+              "[-l <listing>] [--cache <dir>] [--cache-size <MB>] <input> "
+              "[<preprocessing>] <output>\n"
+              "       assembler [--jobs <n>] [--manifest <list>] [--keep-going] "
+              "[--max-errors <n>] [--cache <dir>] [--cache-size <MB>] <input>...");
     
     *infile = argv[1];
-    *prefile = argv[2];
-    *outfile = argv[3];
-    
-    printf("===== Parsing arguments =====\n");
-    printf("Input file: %s\n", *infile);
-    printf("Pre-processing file: %s\n", *prefile);
-    printf("Output file: %s\n", *outfile);
-    printf("\n");
-}
\ No newline at end of file
+    *prefile = (argc == 4) ? argv[2] : NULL;
+    *outfile = argv[argc - 1];
+}
+
+/**
+ * Assemble a file, as main does without a cache.
+ * @param infile input file name with code in assembly
+ * @param prefile output file name for preprocessed code, or NULL when not given
+ * @param outfile output file name for object code
+ * @param options options given
+ * @return type of the first error found when keeping going, or 0 if the file was
+ *         assembled
+ */
+int assemble_file(char *infile, char *prefile, char *outfile, options_t *options)
+{
+    preprocessor_t preprocessor;
+    
+    if (options->max_errors)
+        return assemble_keep_going(infile, prefile, outfile, options);
+    
+    preprocess(&preprocessor, infile, prefile, options->is_pipelined,
+               options->listing != NULL);
+    assemble(&preprocessor, outfile, options->listing);
+    preprocessor_destroy(&preprocessor);
+    
+    return 0;
+}
+
+/**
+ * Assemble a file through the cache. The object file, and the preprocessed file and the
+ * listing when given, are taken from the cache when the input file did not change.
+ * Otherwise the file is assembled, its outputs are added to the cache and the least
+ * recently used entries are removed when the cache grows too large. Any failure of the
+ * cache itself falls back to assembling.
+ * @param infile input file name with code in assembly
+ * @param prefile output file name for preprocessed code, or NULL when not given
+ * @param outfile output file name for object code
+ * @param options options given
+ * @return type of the first error found when keeping going, or 0 if the file was
+ *         assembled
+ */
+int assemble_cached(char *infile, char *prefile, char *outfile, options_t *options)
+{
+    cache_t cache;
+    char key[CACHE_KEY_SIZE + 1];
+    char *outputs[CACHE_KIND_COUNT];
+    int status;
+    
+    if (cache_init(&cache, options->cache, options->cache_limit) != CACHE_OK)
+        error(ERROR_COMMAND_LINE, "Cannot use cache directory %s", options->cache);
+    
+    outputs[CACHE_OBJECT] = outfile;
+    outputs[CACHE_PREPROCESSED] = prefile;
+    outputs[CACHE_LISTING] = options->listing;
+    
+    if (cache_key(infile, key) != CACHE_OK)
+        return assemble_file(infile, prefile, outfile, options);
+    
+    if (cache_fetch(&cache, key, outputs) == CACHE_OK)
+        return 0;
+    
+    status = assemble_file(infile, prefile, outfile, options);
+    
+    if (status == 0)
+    {
+        cache_store(&cache, key, outputs);
+        cache_evict(&cache);
+    }
+    
+    return status;
+}
+
+/**
+ * Assemble a file, going on after errors so every error found is printed once the
+ * assembly is over, sorted by line number. It stops early at the first error found once
+ * max_errors errors were collected. The assembly runs within an assembly context, which collects the errors; no
+ * object file is left behind if there was any.
+ * @param infile input file name with code in assembly
+ * @param prefile output file name for preprocessed code, or NULL when not given
+ * @param outfile output file name for object code
+ * @param options options given, with the number of errors after which the assembly stops
+ * @return type of the first error found, or 0 if the file was assembled
+ */
+int assemble_keep_going(char *infile, char *prefile, char *outfile, options_t *options)
+{
+    int max_errors = options->max_errors;
+    context_t *context = malloc(sizeof(context_t));
+    preprocessor_t *preprocessor = malloc(sizeof(preprocessor_t));
+    diagnostics_t *diagnostics = malloc(sizeof(diagnostics_t));
+    int status;
+    
+    if (!context || !preprocessor || !diagnostics ||
+        !diagnostics_init(diagnostics, max_errors))
+        error(ERROR_COMMAND_LINE, "Cannot allocate memory for %d errors", max_errors);
+    
+    context_init(context, NULL, stderr);
+    context->report = diagnostics_report;
+    context->report_arg = diagnostics;
+    context_enter(context);
+    
+    if (setjmp(context->jump) == 0)
+    {
+        preprocess(preprocessor, infile, prefile, 0, options->listing != NULL);
+        assemble(preprocessor, outfile, options->listing);
+        preprocessor_destroy(preprocessor);
+    }
+    
+    context_cleanup(context);
+    context_leave();
+    
+    diagnostics_print(diagnostics, stderr);
+    status = context->status;
+    
+    diagnostics_destroy(diagnostics);
+    free(diagnostics);
+    free(preprocessor);
+    free(context);
+    
+    return status;
+}
+
+/**
+ * Assemble every input file, and every file listed in the manifest, as a batch. Each
+ * object file is named after its input file. Uses one job per processor when --jobs is
+ * not given.
+ * @param argc number of arguments, after the options
+ * @param argv command line arguments, with the input file names from argv[1]
+ * @param options options given
+ * @return exit status of the first file which failed, or 0 if every file was assembled
+ */
+int assemble_batch(int argc, char **argv, options_t *options)
+{
+    batch_t batch;
+    cache_t cache;
+    int jobs = options->jobs;
+    int status;
+    int i;
+    
+    if (options->is_pipelined)
+        error(ERROR_COMMAND_LINE, "--pipeline cannot be used for a batch");
+    
+    if (options->listing)
+        error(ERROR_COMMAND_LINE, "-l cannot be used for a batch");
+    
+    if (!jobs)
+        jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    
+    batch_init(&batch);
+    batch.max_errors = options->max_errors;
+    
+    if (options->cache)
+    {
+        if (cache_init(&cache, options->cache, options->cache_limit) != CACHE_OK)
+            error(ERROR_COMMAND_LINE, "Cannot use cache directory %s", options->cache);
+        
+        batch.cache = &cache;
+    }
+    
+    if (options->manifest)
+        batch_add_manifest(&batch, options->manifest);
+    
+    for (i = 1; i < argc; ++i)
+        batch_add(&batch, argv[i]);
+    
+    if (batch.count == 0)
+        error(ERROR_COMMAND_LINE, "No input files");
+    
+    batch_run(&batch, jobs);
+    status = batch_report(&batch);
+    batch_destroy(&batch);
+    
+    return status;
+}
@@ -9,68 +9,304 @@
 
 #include "object_file.h"
 
+/* Partial output file, removed if the program exits before it is complete */
+static char *partial_filename = NULL;
+
+/**
+ * Split the program in the text, data and BSS sections of an object image. The section
+ * that comes first also holds any word before its SECTION directive. BSS is made of the
+ * zero-filled words still pending at the end, when the data section is the last one.
+ * Otherwise, they are filled here.
+ * @param object_ptr Pointer to an object file struct, with both sections defined.
+ * @param image Image receiving the sections.
+ */
+void object_file_sections(object_file_t *object_ptr, object_image_t *image)
+{
+    object_section_t *text = &image->sections[OBJECT_SECTION_TEXT];
+    object_section_t *data = &image->sections[OBJECT_SECTION_DATA];
+    object_section_t *bss = &image->sections[OBJECT_SECTION_BSS];
+    
+    if (object_ptr->text_section_address < object_ptr->data_section_address)
+    {
+        text->address = 0;
+        data->address = object_ptr->data_section_address;
+        bss->address = object_ptr->base + object_ptr->length;
+        if (bss->address < data->address)
+            bss->address = data->address;
+    }
+    else
+    {
+        object_file_fill_zeroes(object_ptr);
+    
+        data->address = 0;
+        text->address = object_ptr->text_section_address;
+        bss->address = object_ptr->size;
+    }
+    
+    text->size = (text->address == 0) ? data->address : bss->address - text->address;
+    data->size = (data->address == 0) ? text->address : bss->address - data->address;
+    bss->size = object_ptr->size - bss->address;
+    
+    /* Words are only available when the whole program is in memory */
+    text->words = object_ptr->program + text->address;
+    data->words = object_ptr->program + data->address;
+    image->entry = object_ptr->text_section_address;
+    
+    image->symbols = object_ptr->symbols;
+    image->symbol_count = object_ptr->symbol_count;
+    image->relocations = object_ptr->relocations;
+    image->relocation_count = object_ptr->relocation_count;
+    if (object_ptr->symbol_count > 0)
+        image->flags |= OBJECT_FORMAT_HAS_SYMBOLS;
+}
+
+/**
+ * Assign every exported symbol to the section holding its address.
+ * @param object_ptr Pointer to an object file struct.
+ * @param image Image with the sections already set.
+ */
+void object_file_symbol_sections(object_file_t *object_ptr, object_image_t *image)
+{
+    object_section_t *section;
+    object_symbol_t *symbol;
+    int i, j;
+    
+    for (i = 0; i < object_ptr->symbol_count; ++i)
+    {
+        symbol = &object_ptr->symbols[i];
+        symbol->section = OBJECT_SECTION_TEXT;
+    
+        for (j = 0; j < OBJECT_SECTION_COUNT; ++j)
+        {
+            section = &image->sections[j];
+    
+            if ((section->size > 0) && (symbol->value >= section->address) &&
+                (symbol->value < section->address + section->size))
+                symbol->section = j;
+        }
+    }
+}
+
 /**
- * Writes the object file to a binary file.
- * The binary file starts with a header containing the program size and the text section
- * address. 
- *  -----------------------------------------------------------------------
- * |    1 int     |        1 int         | Program size*sizeof(obj_t) bytes|
- * | Program size | Text section address |        Compiled program         |
- *  -----------------------------------------------------------------------
+ * Writes an object file held in memory to a binary file, in the format described at
+ * object_format.h. Only the initialized words are written: the BSS words are zero-filled
+ * by the loader. Streamed object files are written by object_file_close instead.
  * @param filename Name of the output object file.
- * @param object Object file struct.
+ * @param object_ptr Pointer to an object file struct.
  */
-void object_file_write(char *filename, object_file_t object)
+void object_file_write(char *filename, object_file_t *object_ptr)
 {
     FILE *fp = file_open(filename, "wb");
+    object_image_t image;
+    int status;
     
-    /* Writing header */
-    fwrite(&object.size, sizeof(int), 1, fp); /* Program size */
-    fwrite(&object.text_section_address, sizeof(int), 1, fp); /* Text section address */
+    object_format_init(&image);
+    object_file_sections(object_ptr, &image);
+    object_file_symbol_sections(object_ptr, &image);
     
-    /* Writing program */
-    fwrite(object.program, sizeof(obj_t), object.size, fp);
+    status = object_format_write(fp, &image);
     file_close(fp);
+    
+    if (status != OBJECT_FORMAT_OK)
+    {
+        remove(filename);
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: %s \"%s\"",
+              object_format_strerror(status), filename);
+    }
+}
+
+/**
+ * Write an object file struct, kept in memory, to a newly allocated buffer.
+ * @param object_ptr Pointer to an object file struct, with both sections defined.
+ * @param buffer Stores the object file contents, which must be freed.
+ * @param size Stores the size of the object file, in bytes.
+ */
+void object_file_write_buffer(object_file_t *object_ptr, unsigned char **buffer,
+                              size_t *size)
+{
+    object_image_t image;
+    char *data = NULL;
+    size_t data_size = 0;
+    FILE *fp = open_memstream(&data, &data_size);
+    int status;
+    
+    if (!fp)
+        error(ERROR_OBJECT_FILE, "Cannot allocate memory for object file");
+    
+    object_format_init(&image);
+    object_file_sections(object_ptr, &image);
+    object_file_symbol_sections(object_ptr, &image);
+    
+    status = object_format_write(fp, &image);
+    
+    if ((fclose(fp) != 0) && (status == OBJECT_FORMAT_OK))
+        status = OBJECT_FORMAT_IO_ERROR;
+    
+    if (status != OBJECT_FORMAT_OK)
+    {
+        free(data);
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: %s", object_format_strerror(status));
+    }
+    
+    *buffer = (unsigned char*)data;
+    *size = data_size;
 }
 
 /**
  * Read an object binary file, saving it to an object file struct, and print on the screen.
+ * The file is validated before loading, and BSS is kept as pending zero-filled words.
  * @param filename Name of the input object file.
  * @param object_ptr Pointer to an object file struct.
  */
 void object_file_read(char *filename, object_file_t *object_ptr)
 {
-    FILE *fp = fopen(filename, "rb");
+    object_image_t image;
+    object_mapping_t mapping;
+    int status;
     int i;
     
-    /* Reading header */
-    fread(&object_ptr->size, sizeof(int), 1, fp); /* Program size */
-    fread(&object_ptr->text_section_address, sizeof(int), 1, fp); /* Text section address */
+    status = object_format_map(filename, &mapping);
+    if (status == OBJECT_FORMAT_OK)
+        status = object_format_parse(mapping.data, mapping.length, &image);
+    if (status != OBJECT_FORMAT_OK)
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: %s \"%s\"",
+              object_format_strerror(status), filename);
+    
+    /* Loading sections */
+    object_file_init(object_ptr);
+    object_file_reserve(object_ptr, image.sections[OBJECT_SECTION_BSS].address);
+    for (i = 0; i < OBJECT_SECTION_BSS; ++i)
+        object_format_load_section(&image, i,
+                                   object_ptr->program + image.sections[i].address);
     
-    /* Reading program */
-    object_ptr->program = malloc(sizeof(obj_t)*object_ptr->size);
-    fread(object_ptr->program, sizeof(obj_t), object_ptr->size, fp);
+    object_ptr->length = image.sections[OBJECT_SECTION_BSS].address;
+    object_ptr->size = object_format_image_size(&image);
+    object_ptr->text_section_address = image.entry;
+    object_ptr->data_section_address = image.sections[OBJECT_SECTION_DATA].address;
+    object_format_unmap(&mapping);
     
     /* Printing to the screen */
-    printf("\n===== %s =====\n\n", filename);
+    context_printf("\n===== %s =====\n\n", filename);
     for (i = 0; i < object_ptr->size; ++i)
-        printf("(addr. %d): %d\n", i, object_ptr->program[i]);
-    printf("\n==========\n");
-    
-    fclose(fp);
+        context_printf("(addr. %d): %d\n", i, object_file_get(object_ptr, i));
+    context_printf("\n==========\n");
 }
 
 /**
- * Initialise an object file struct.
+ * Initialise an object file struct, which holds the whole program in memory.
  * @param object_ptr Pointer to an allocated object file struct.
  */
 void object_file_init(object_file_t *object_ptr)
 {
     object_ptr->program = NULL;
-    object_ptr->offset = NULL;
+    object_ptr->base = 0;
+    object_ptr->length = 0;
     object_ptr->size = 0;
+    object_ptr->capacity = 0;
     object_ptr->text_section_address = -1;
     object_ptr->data_section_address = -1;
+    object_ptr->symbols = NULL;
+    object_ptr->symbol_count = 0;
+    object_ptr->symbol_capacity = 0;
+    object_ptr->relocations = NULL;
+    object_ptr->relocation_count = 0;
+    object_ptr->relocation_capacity = 0;
+    object_ptr->stream.fp = NULL;
+    object_ptr->stream.relocations = NULL;
+    object_ptr->filename = NULL;
+    object_ptr->partial_filename = NULL;
+}
+
+/**
+ * Initialise an object file struct that streams the program to a file as it grows, so
+ * that only a window of OBJECT_FILE_STREAM_WINDOW words is kept in memory. The file is
+ * written under a partial name and only gets its final name when closed with
+ * object_file_close. Until then, it is removed if the program exits, or by
+ * object_file_abort within an assembly context, where errors do not exit.
+ * @param object_ptr Pointer to an allocated object file struct.
+ * @param filename Name of the output object file.
+ */
+void object_file_open(object_file_t *object_ptr, char *filename)
+{
+    object_file_init(object_ptr);
+    object_file_reserve(object_ptr, OBJECT_FILE_STREAM_WINDOW);
+    
+    object_ptr->filename = malloc(strlen(filename) + 1);
+    strcpy(object_ptr->filename, filename);
+    object_ptr->partial_filename = malloc(strlen(filename) +
+                                          strlen(OBJECT_FILE_PARTIAL_SUFFIX) + 1);
+    strcpy(object_ptr->partial_filename, filename);
+    strcat(object_ptr->partial_filename, OBJECT_FILE_PARTIAL_SUFFIX);
+    
+    if (object_format_stream_open(&object_ptr->stream, object_ptr->partial_filename) !=
+        OBJECT_FORMAT_OK)
+        error(ERROR_FILE, "Cannot open file \"%s\"", object_ptr->partial_filename);
+    
+    /* Several files may be assembled at once within contexts, so none is kept here */
+    if (context_current())
+        return;
+    
+    if (partial_filename == NULL)
+        atexit(object_file_remove_partial);
+    partial_filename = object_ptr->partial_filename;
+}
+
+/**
+ * Finish a streamed object file: flush the remaining words, write the tables and the
+ * header and give the file its final name.
+ * @param object_ptr Pointer to an object file struct opened with object_file_open.
+ */
+void object_file_close(object_file_t *object_ptr)
+{
+    object_image_t image;
+    int status;
+    
+    object_format_init(&image);
+    object_file_sections(object_ptr, &image);
+    object_file_symbol_sections(object_ptr, &image);
+    object_file_flush(object_ptr);
+    
+    status = object_format_stream_close(&object_ptr->stream, &image);
+    if ((status == OBJECT_FORMAT_OK) &&
+        (rename(object_ptr->partial_filename, object_ptr->filename) != 0))
+        status = OBJECT_FORMAT_IO_ERROR;
+    
+    if (status != OBJECT_FORMAT_OK)
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: %s \"%s\"",
+              object_format_strerror(status), object_ptr->filename);
+    
+    if (partial_filename == object_ptr->partial_filename)
+        partial_filename = NULL;
+    
+    free(object_ptr->partial_filename);
+    object_ptr->partial_filename = NULL;
+}
+
+/**
+ * Give up a streamed object file which was not closed, removing its partial output file.
+ * Does nothing if the object file was closed or never opened.
+ * @param object_ptr Pointer to an object file struct.
+ */
+void object_file_abort(object_file_t *object_ptr)
+{
+    object_format_stream_abort(&object_ptr->stream);
+    
+    if (object_ptr->partial_filename)
+    {
+        remove(object_ptr->partial_filename);
+        free(object_ptr->partial_filename);
+        object_ptr->partial_filename = NULL;
+    }
+}
+
+/**
+ * Remove the output file being streamed, if any. Registered to run at exit, so that
+ * errors found while assembling leave no incomplete object file behind.
+ */
+void object_file_remove_partial(void)
+{
+    if (partial_filename != NULL)
+        remove(partial_filename);
 }
 
 /**
@@ -80,50 +316,191 @@ void object_file_init(object_file_t *object_ptr)
 void object_file_destroy(object_file_t *object_ptr)
 {
     free(object_ptr->program);
+    free(object_ptr->symbols);
+    free(object_ptr->relocations);
+    free(object_ptr->filename);
+    free(object_ptr->partial_filename);
+    object_file_init(object_ptr);
+}
+
+/**
+ * Make sure the object file can hold at least the given number of words in memory without
+ * further allocations. The capacity at least doubles each time it grows.
+ * @param object_ptr Pointer to an allocated object file struct.
+ * @param capacity Minimum number of words.
+ */
+void object_file_reserve(object_file_t *object_ptr, int capacity)
+{
+    int new_capacity;
+    
+    if (capacity <= object_ptr->capacity)
+        return;
+    
+    new_capacity = (object_ptr->capacity > 0) ? 2*object_ptr->capacity
+                                               : OBJECT_FILE_INITIAL_CAPACITY;
+    if (new_capacity < capacity)
+        new_capacity = capacity;
+    
+    object_ptr->program = realloc(object_ptr->program, sizeof(obj_t)*new_capacity);
+    object_ptr->capacity = new_capacity;
+}
+
+/**
+ * Write the words in memory to the output file and empty the window. Does nothing when
+ * the object file is not streamed.
+ * @param object_ptr Pointer to an allocated object file struct.
+ */
+void object_file_flush(object_file_t *object_ptr)
+{
+    if (object_ptr->stream.fp == NULL)
+        return;
+    
+    if (object_format_stream_write(&object_ptr->stream, object_ptr->program,
+                                   object_ptr->length) != OBJECT_FORMAT_OK)
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: Cannot write to \"%s\"",
+              object_ptr->filename);
+    
+    object_ptr->base += object_ptr->length;
+    object_ptr->length = 0;
+}
+
+/**
+ * Append a word right after the words in memory, flushing them first when the window is
+ * full or growing the buffer otherwise. Pending zero-filled words must be filled first.
+ * @param object_ptr Pointer to an allocated object file struct.
+ * @param value Value of the word.
+ */
+void object_file_append(object_file_t *object_ptr, obj_t value)
+{
+    if (object_ptr->length == object_ptr->capacity)
+    {
+        if (object_ptr->stream.fp != NULL)
+            object_file_flush(object_ptr);
+        else
+            object_file_reserve(object_ptr, object_ptr->length + 1);
+    }
+    
+    object_ptr->program[object_ptr->length] = value;
+    ++object_ptr->length;
+}
+
+/**
+ * Fill the pending zero-filled words, which are needed once an initialized word follows
+ * them.
+ * @param object_ptr Pointer to an allocated object file struct.
+ */
+void object_file_fill_zeroes(object_file_t *object_ptr)
+{
+    int num = object_ptr->size - (object_ptr->base + object_ptr->length);
+    int block;
+    
+    if (object_ptr->stream.fp == NULL)
+        object_file_reserve(object_ptr, object_ptr->size);
+    
+    while (num > 0)
+    {
+        if (object_ptr->length == object_ptr->capacity)
+            object_file_flush(object_ptr);
+    
+        block = object_ptr->capacity - object_ptr->length;
+        if (block > num)
+            block = num;
+    
+        memset(&object_ptr->program[object_ptr->length], 0, sizeof(obj_t)*block);
+        object_ptr->length += block;
+        num -= block;
+    }
 }
 
 /**
  * Add a new value to the end of an object file compiled program, increases the object
- * program size, allocate memory for it and set the offset to zero.
+ * program size and allocate memory for it if needed.
  * @param object_ptr Pointer to an allocated object file struct.
  * @param value Value to be added to the object file program.
  */
 void object_file_add(object_file_t *object_ptr, obj_t value)
 {
+    object_file_fill_zeroes(object_ptr);
+    object_file_append(object_ptr, value);
     ++object_ptr->size;
+}
+
+/**
+ * Add a block of zero values to the end of an object file compiled
+ * program. They are only counted until an initialized word follows them, so a block at the
+ * end of the program costs no memory and is stored as BSS in the object file.
+ * @param object_ptr Pointer to an allocated object file struct.
+ * @param num Number of words to be added.
+ */
+void object_file_add_zeroes(object_file_t *object_ptr, int num)
+{
+    if (num > 0)
+        object_ptr->size += num;
+}
+
+/**
+ * Export a symbol to the symbol table of the object file. Its section is found when
+ * writing the file.
+ * @param object_ptr Pointer to an allocated object file struct.
+ * @param name Symbol name, which must be valid until the object file is written.
+ * @param value Symbol address.
+ * @param flags Symbol flags, such as OBJECT_SYMBOL_CONSTANT.
+ */
+void object_file_add_symbol(object_file_t *object_ptr, const char *name, int value,
+                            int flags)
+{
+    object_symbol_t *symbol;
     
-    /* Not allocated yet */
-    if (object_ptr->size == 1)
+    if (object_ptr->symbol_count == object_ptr->symbol_capacity)
     {
-        object_ptr->program = malloc(sizeof(obj_t));
-        object_ptr->offset = malloc(sizeof(int));
+        object_ptr->symbol_capacity = (object_ptr->symbol_capacity > 0)
+                                      ? 2*object_ptr->symbol_capacity
+                                      : OBJECT_FILE_INITIAL_CAPACITY;
+        object_ptr->symbols = realloc(object_ptr->symbols, sizeof(object_symbol_t)*
+                                                           object_ptr->symbol_capacity);
     }
-    else
-    {
-        object_ptr->program = realloc(object_ptr->program, sizeof(obj_t)*object_ptr->size);
-        object_ptr->offset = realloc(object_ptr->offset, sizeof(int)*object_ptr->size);
-    }
-        
-    object_ptr->program[object_ptr->size - 1] = value;
-    object_ptr->offset[object_ptr->size - 1] = 0;
+    
+    symbol = &object_ptr->symbols[object_ptr->symbol_count++];
+    symbol->name = name;
+    symbol->value = value;
+    symbol->section = OBJECT_SECTION_TEXT;
+    symbol->flags = flags;
 }
 
 /**
- * Add a new value to the end of an object file compiled program with an offset.
+ * Mark a program position as holding an absolute address, so that it is listed in the
+ * relocation table of the object file. When streaming, the entry goes straight to the
+ * stream instead of memory.
  * @param object_ptr Pointer to an allocated object file struct.
- * @param value Value to be added to the object file program.
- * @param offset Offset value.
+ * @param position Program position.
  */
-void object_file_add_with_offset(object_file_t *object_ptr, obj_t value, int offset)
+void object_file_add_relocation(object_file_t *object_ptr, int position)
 {
-    object_file_add(object_ptr, value);
+    if (object_ptr->stream.fp != NULL)
+    {
+        if (object_format_stream_add_relocation(&object_ptr->stream, position) !=
+            OBJECT_FORMAT_OK)
+            error(ERROR_OBJECT_FILE, "ERROR [object_file]: Cannot write to \"%s\"",
+                  object_ptr->filename);
+        return;
+    }
+    
+    if (object_ptr->relocation_count == object_ptr->relocation_capacity)
+    {
+        object_ptr->relocation_capacity = (object_ptr->relocation_capacity > 0)
+                                          ? 2*object_ptr->relocation_capacity
+                                          : OBJECT_FILE_INITIAL_CAPACITY;
+        object_ptr->relocations = realloc(object_ptr->relocations, sizeof(int)*
+                                          object_ptr->relocation_capacity);
+    }
     
-    object_ptr->offset[object_ptr->size - 1] = offset;
+    object_ptr->relocations[object_ptr->relocation_count++] = position;
 }
 
 /**
  * Insert a value to an already existent program position. If there is a need to append a
- * new value to the end of the program, use the object_file_add function.
+ * new value to the end of the program, use the object_file_add function. Positions already
+ * flushed to a streamed object file are patched in place.
  * @param object_ptr Pointer to an allocated object file struct.
  * @param position Position to insert the value.
  * @param value Value to be added to the object file program.
@@ -136,53 +513,105 @@ void object_file_insert(object_file_t *object_ptr, int position, obj_t value)
                                  "Object file size: %d\tPosition: %d\n",
                                  object_ptr->size, position);
     
-    object_ptr->program[position] = value;
+    if (position >= object_ptr->base + object_ptr->length)
+        object_file_fill_zeroes(object_ptr);
+    
+    if (position >= object_ptr->base)
+        object_ptr->program[position - object_ptr->base] = value;
+    else if (object_format_stream_patch(&object_ptr->stream, position, value) !=
+             OBJECT_FORMAT_OK)
+        error(ERROR_OBJECT_FILE, "ERROR [object_file]: Cannot write to \"%s\"",
+              object_ptr->filename);
 }
 
 /**
- * Get the value of an existent program position.
+ * Get the values of consecutive program positions, wherever they are: flushed to a
+ * streamed object file, in memory or still pending as zero-filled words.
  * @param object_ptr Pointer to an allocated object file struct.
- * @param position Position to get the value.
+ * @param position First position to get.
+ * @param words Destination of the values.
+ * @param num Number of positions.
  */
-obj_t object_file_get(object_file_t object, int position)
+void object_file_get_words(object_file_t *object_ptr, int position, obj_t *words,
+                           int num)
 {
-    if (position >= object.size)
+    int block;
+    
+    if ((position < 0) || (num < 0) || (position + num > object_ptr->size))
         error(ERROR_OBJECT_FILE, "ERROR [object_file]: Trying to get a value at an "
                                  "invalid position\n"
                                  "Object file size: %d\tPosition: %d\n",
-                                 object.size, position);
-                                 
-    return object.program[position];
+                                 object_ptr->size, position + num - 1);
+    
+    if (position < object_ptr->base)
+    {
+        block = object_ptr->base - position;
+        if (block > num)
+            block = num;
+    
+        if (object_format_stream_read(&object_ptr->stream, position, words, block) !=
+            OBJECT_FORMAT_OK)
+            error(ERROR_OBJECT_FILE, "ERROR [object_file]: Cannot read from \"%s\"",
+                  object_ptr->filename);
+    
+        words += block;
+        position += block;
+        num -= block;
+    }
+    
+    if ((num > 0) && (position < object_ptr->base + object_ptr->length))
+    {
+        block = object_ptr->base + object_ptr->length - position;
+        if (block > num)
+            block = num;
+    
+        memcpy(words, &object_ptr->program[position - object_ptr->base],
+               sizeof(obj_t)*block);
+    
+        words += block;
+        position += block;
+        num -= block;
+    }
+    
+    if (num > 0)
+        memset(words, 0, sizeof(obj_t)*num);
 }
 
 /**
- * Get the offset of an existent program position.
+ * Get the value of an existent program position.
  * @param object_ptr Pointer to an allocated object file struct.
  * @param position Position to get the value.
  */
-int object_file_get_offset(object_file_t object, int position)
+obj_t object_file_get(object_file_t *object_ptr, int position)
 {
-    if (position >= object.size)
-        error(ERROR_OBJECT_FILE, "ERROR [object_file]: Trying to get an offset at an "
-                                 "invalid position\n"
-                                 "Object file size: %d\tPosition: %d\n",
-                                 object.size, position);
-
-    return object.offset[position];
+    obj_t value;
+    
+    object_file_get_words(object_ptr, position, &value, 1);
+    return value;
 }
 
 /**
- * Print an object program.
+ * Print an object program, reading back the words already flushed when streaming.
  * @param object_ptr Pointer to an allocated object file struct.
  */
-void object_file_print(object_file_t object)
+void object_file_print(object_file_t *object_ptr)
 {
-    int i;
+    obj_t words[256];
+    int block;
+    int i, j;
     
-    printf("===== Object file =====\n");
+    context_printf("===== Object file =====\n");
     
-    for (i = 0; i < object.size; ++i)
-        printf("(addr. %2.2d): %d\n", i, object_file_get(object, i));
+    for (i = 0; i < object_ptr->size; i += block)
+    {
+        block = object_ptr->size - i;
+        if (block > 256)
+            block = 256;
     
-    printf("\n");
-}
\ No newline at end of file
+        object_file_get_words(object_ptr, i, words, block);
+        for (j = 0; j < block; ++j)
+            context_printf("(addr. %2.2d): %d\n", i + j, words[j]);
+    }
+    
+    context_printf("\n");
+}
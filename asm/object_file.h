@@ -12,38 +12,87 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "error.h"
 #include "file.h"
+#include "object_format.h"
 
-/* Object file has one byte elements */
-typedef short int obj_t;
+/* Initial capacity of the program buffer, in words */
+#define OBJECT_FILE_INITIAL_CAPACITY 256
+
+/* Words kept in memory when streaming, flushed to the output file once full */
+#define OBJECT_FILE_STREAM_WINDOW 4096
+
+/* Suffix of the output file while it is being streamed */
+#define OBJECT_FILE_PARTIAL_SUFFIX ".part"
 
 /*
- * An object file struct contains five sections:
- * - program: Contains the compiled program, which will be written to the object file.
- * - offset: Offset, used for array accessing.
- * - size: Current program size, in words.
+ * An object file struct contains the following sections:
+ * - program: Words from base to base + length. It holds the whole program in memory, or
+ *            only the last words not yet flushed when streaming.
+ * - base: Address of the first word in program. Always zero in memory.
+ * - length: Number of words in program.
+ * - size: Current program size, in words. Words from base + length to size are zero-filled
+ *         words reserved with object_file_add_zeroes which were not needed yet. If no
+ *         initialized word follows them, they are not written to the object file, only
+ *         their count, and the loader zero-fills them (BSS).
+ * - capacity: Number of words allocated for program. It grows geometrically,
+ *             so adding a word costs amortized O(1).
  * - text_section_address: Start of the text section.
  * - data_section_address: Start of the data section.
+ * - symbols: Symbols exported to the symbol table of the object file. Their names are
+ *            not copied and must be valid until the object file is written.
+ * - relocations: Addresses of the words holding absolute addresses, kept in memory only
+ *                when not streaming, as the stream spills them to a temporary file.
+ * - stream: Output file when streaming, with a NULL file pointer otherwise.
+ * - filename: Name of the output file when streaming.
+ * - partial_filename: Name the output file is written under until it is closed.
  */
 typedef struct
 {
     obj_t *program;
-    int *offset;
+    int base;
+    int length;
     int size;
+    int capacity;
     int text_section_address;
     int data_section_address;
+    object_symbol_t *symbols;
+    int symbol_count;
+    int symbol_capacity;
+    int *relocations;
+    int relocation_count;
+    int relocation_capacity;
+    object_stream_t stream;
+    char *filename;
+    char *partial_filename;
 } object_file_t;
 
-void object_file_write(char *filename, object_file_t object);
+void object_file_sections(object_file_t *object_ptr, object_image_t *image);
+void object_file_symbol_sections(object_file_t *object_ptr, object_image_t *image);
+void object_file_write(char *filename, object_file_t *object_ptr);
+void object_file_write_buffer(object_file_t *object_ptr, unsigned char **buffer,
+                              size_t *size);
 void object_file_read(char *filename, object_file_t *object_ptr);
 void object_file_init(object_file_t *object_ptr);
+void object_file_open(object_file_t *object_ptr, char *filename);
+void object_file_close(object_file_t *object_ptr);
+void object_file_abort(object_file_t *object_ptr);
+void object_file_remove_partial(void);
 void object_file_destroy(object_file_t *object_ptr);
+void object_file_reserve(object_file_t *object_ptr, int capacity);
+void object_file_flush(object_file_t *object_ptr);
+void object_file_append(object_file_t *object_ptr, obj_t value);
+void object_file_fill_zeroes(object_file_t *object_ptr);
 void object_file_add(object_file_t *object_ptr, obj_t value);
-void object_file_add_with_offset(object_file_t *object_ptr, obj_t value, int offset);
+void object_file_add_zeroes(object_file_t *object_ptr, int num);
+void object_file_add_symbol(object_file_t *object_ptr, const char *name, int value,
+                            int flags);
+void object_file_add_relocation(object_file_t *object_ptr, int position);
 void object_file_insert(object_file_t *object_ptr, int position, obj_t value);
-obj_t object_file_get(object_file_t object, int position);
-int object_file_get_offset(object_file_t object, int position);
-void object_file_print(object_file_t object);
+void object_file_get_words(object_file_t *object_ptr, int position, obj_t *words,
+                           int num);
+obj_t object_file_get(object_file_t *object_ptr, int position);
+void object_file_print(object_file_t *object_ptr);
 
-#endif /* _OBJECT_FILE_H_ */
\ No newline at end of file
+#endif /* _OBJECT_FILE_H_ */
@@ -0,0 +1,953 @@
+/**
+ * @file   object_format.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the object file format reader and writer
+ */
+
+#include "object_format.h"
+
+/* CRC-32 (IEEE 802.3, reflected) remainders for every nibble */
+static const unsigned long crc32_nibble_table[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+/**
+ * Initialise an empty object image, with the current format version.
+ * @param image Pointer to an allocated object image.
+ */
+void object_format_init(object_image_t *image)
+{
+    memset(image, 0, sizeof(object_image_t));
+    image->version = OBJECT_FORMAT_VERSION;
+}
+
+/**
+ * Store an unsigned 16-bit value in little-endian byte order.
+ * @param buffer Destination, with at least two bytes.
+ * @param value Value to be stored.
+ */
+void object_format_put_u16(unsigned char *buffer, unsigned long value)
+{
+    buffer[0] = (unsigned char)(value & 0xFF);
+    buffer[1] = (unsigned char)((value >> 8) & 0xFF);
+}
+
+/**
+ * Store an unsigned 32-bit value in little-endian byte order.
+ * @param buffer Destination, with at least four bytes.
+ * @param value Value to be stored.
+ */
+void object_format_put_u32(unsigned char *buffer, unsigned long value)
+{
+    object_format_put_u16(buffer, value & 0xFFFF);
+    object_format_put_u16(buffer + 2, (value >> 16) & 0xFFFF);
+}
+
+/**
+ * Load an unsigned 16-bit little-endian value.
+ * @param buffer Source, with at least two bytes.
+ * @return Loaded value.
+ */
+unsigned long object_format_get_u16(const unsigned char *buffer)
+{
+    return (unsigned long)buffer[0] | ((unsigned long)buffer[1] << 8);
+}
+
+/**
+ * Load an unsigned 32-bit little-endian value.
+ * @param buffer Source, with at least four bytes.
+ * @return Loaded value.
+ */
+unsigned long object_format_get_u32(const unsigned char *buffer)
+{
+    return object_format_get_u16(buffer) | (object_format_get_u16(buffer + 2) << 16);
+}
+
+/**
+ * Update a CRC-32 with a block of bytes. Start with a zero CRC.
+ * @param crc CRC of the previous bytes.
+ * @param data Bytes to be added.
+ * @param length Number of bytes.
+ * @return Updated CRC.
+ */
+unsigned long object_format_crc32(unsigned long crc, const unsigned char *data,
+                                  unsigned long length)
+{
+    unsigned long i;
+    
+    crc = ~crc & 0xFFFFFFFFUL;
+    
+    for (i = 0; i < length; ++i)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xF];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xF];
+    }
+    
+    return ~crc & 0xFFFFFFFFUL;
+}
+
+/**
+ * CRC-32 of words, as they are stored in the object file.
+ * @param words Words of a section.
+ * @param size Number of words.
+ * @return CRC of the little-endian encoding of the words.
+ */
+unsigned long object_format_crc32_words(const obj_t *words, int size)
+{
+    unsigned char buffer[OBJECT_FORMAT_WORD_SIZE];
+    unsigned long crc = 0;
+    int i;
+    
+    for (i = 0; i < size; ++i)
+    {
+        object_format_put_u16(buffer, (unsigned long)words[i] & 0xFFFF);
+        crc = object_format_crc32(crc, buffer, OBJECT_FORMAT_WORD_SIZE);
+    }
+    
+    return crc;
+}
+
+/**
+ * Write words in little-endian byte order, a block at a time.
+ * @param fp Output file.
+ * @param words Words to be written.
+ * @param size Number of words.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_write_words(FILE *fp, const obj_t *words, int size)
+{
+    unsigned char buffer[256*OBJECT_FORMAT_WORD_SIZE];
+    int block;
+    int i;
+    
+    while (size > 0)
+    {
+        block = (size < 256) ? size : 256;
+    
+        for (i = 0; i < block; ++i)
+            object_format_put_u16(&buffer[i*OBJECT_FORMAT_WORD_SIZE],
+                                  (unsigned long)words[i] & 0xFFFF);
+    
+        if (fwrite(buffer, OBJECT_FORMAT_WORD_SIZE, block, fp) != (size_t)block)
+            return OBJECT_FORMAT_IO_ERROR;
+    
+        words += block;
+        size -= block;
+    }
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Encode the symbol, relocation and string tables, updating their CRC. When the output
+ * file is NULL, nothing is written, which is used to compute the CRC before writing the
+ * header.
+ * @param fp Output file or NULL.
+ * @param image Image holding the tables.
+ * @param crc Pointer to the CRC to be updated.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_write_tables(FILE *fp, const object_image_t *image, unsigned long *crc)
+{
+    unsigned char entry[OBJECT_FORMAT_SYMBOL_ENTRY_SIZE];
+    unsigned long name_offset = 0;
+    unsigned long length;
+    int i;
+    
+    for (i = 0; i < image->symbol_count; ++i)
+    {
+        object_format_put_u32(entry, name_offset);
+        object_format_put_u32(entry + 4, image->symbols[i].value);
+        object_format_put_u32(entry + 8, image->symbols[i].section);
+        object_format_put_u32(entry + 12, image->symbols[i].flags);
+        name_offset += strlen(image->symbols[i].name) + 1;
+    
+        *crc = object_format_crc32(*crc, entry, OBJECT_FORMAT_SYMBOL_ENTRY_SIZE);
+        if (fp && (fwrite(entry, OBJECT_FORMAT_SYMBOL_ENTRY_SIZE, 1, fp) != 1))
+            return OBJECT_FORMAT_IO_ERROR;
+    }
+    
+    if (image->relocation_file)
+    {
+        if (object_format_copy_relocations(fp, image, crc) != OBJECT_FORMAT_OK)
+            return OBJECT_FORMAT_IO_ERROR;
+    }
+    else
+    {
+        for (i = 0; i < image->relocation_count; ++i)
+        {
+            object_format_put_u32(entry, image->relocations[i]);
+        
+            *crc = object_format_crc32(*crc, entry, OBJECT_FORMAT_RELOCATION_ENTRY_SIZE);
+            if (fp && (fwrite(entry, OBJECT_FORMAT_RELOCATION_ENTRY_SIZE, 1, fp) != 1))
+                return OBJECT_FORMAT_IO_ERROR;
+        }
+    }
+    
+    for (i = 0; i < image->symbol_count; ++i)
+    {
+        length = strlen(image->symbols[i].name) + 1;
+    
+        *crc = object_format_crc32(*crc, (const unsigned char*)image->symbols[i].name,
+                                   length);
+        if (fp && (fwrite(image->symbols[i].name, 1, length, fp) != length))
+            return OBJECT_FORMAT_IO_ERROR;
+    }
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Copy the encoded relocation entries of an image from its relocation file, updating
+ * their CRC. The relocation file is read from its start, a block at a time.
+ * @param fp Output file or NULL.
+ * @param image Image holding the relocation file.
+ * @param crc Pointer to the CRC to be updated.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_copy_relocations(FILE *fp, const object_image_t *image,
+                                   unsigned long *crc)
+{
+    unsigned char buffer[256*OBJECT_FORMAT_RELOCATION_ENTRY_SIZE];
+    unsigned long length = (unsigned long)image->relocation_count*
+                           OBJECT_FORMAT_RELOCATION_ENTRY_SIZE;
+    size_t block;
+    
+    if ((fflush(image->relocation_file) != 0) || (fseek(image->relocation_file, 0,
+                                                         SEEK_SET) != 0))
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    while (length > 0)
+    {
+        block = (length < sizeof(buffer)) ? length : sizeof(buffer);
+    
+        if (fread(buffer, 1, block, image->relocation_file) != block)
+            return OBJECT_FORMAT_IO_ERROR;
+    
+        *crc = object_format_crc32(*crc, buffer, block);
+        if (fp && (fwrite(buffer, 1, block, fp) != block))
+            return OBJECT_FORMAT_IO_ERROR;
+    
+        length -= block;
+    }
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Encode the header and the section table of an image, whose section offsets and CRCs
+ * must already be set.
+ * @param image Image to be described.
+ * @param tables_crc CRC of the symbol, relocation and string tables.
+ * @param header Destination, with OBJECT_FORMAT_CONTENTS_OFFSET bytes.
+ */
+void object_format_encode_header(const object_image_t *image, unsigned long tables_crc,
+                                 unsigned char *header)
+{
+    const object_section_t *section;
+    unsigned char *entry;
+    unsigned long strings_size = 0;
+    int i;
+    
+    for (i = 0; i < image->symbol_count; ++i)
+        strings_size += strlen(image->symbols[i].name) + 1;
+    
+    /* Header */
+    memcpy(header, OBJECT_FORMAT_MAGIC, 4);
+    object_format_put_u16(header + 4, image->version);
+    object_format_put_u16(header + 6, image->flags);
+    object_format_put_u32(header + 8, image->entry);
+    object_format_put_u32(header + 12, OBJECT_SECTION_COUNT);
+    object_format_put_u32(header + 16, image->symbol_count);
+    object_format_put_u32(header + 20, image->relocation_count);
+    object_format_put_u32(header + 24, strings_size);
+    object_format_put_u32(header + 28, tables_crc);
+    
+    /* Section table */
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+    {
+        section = &image->sections[i];
+        entry = header + OBJECT_FORMAT_HEADER_SIZE + i*OBJECT_FORMAT_SECTION_ENTRY_SIZE;
+    
+        object_format_put_u32(entry, i);
+        object_format_put_u32(entry + 4, section->address);
+        object_format_put_u32(entry + 8, section->size);
+        object_format_put_u32(entry + 12, section->offset);
+        object_format_put_u32(entry + 16, section->crc);
+    }
+}
+
+/**
+ * Check that every section of an image to be written ends within the address space, as
+ * the loader requires.
+ * @param image Image with the section addresses and sizes.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_OUT_OF_RANGE.
+ */
+int object_format_check_sections(const object_image_t *image)
+{
+    int i;
+    
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+        if ((image->sections[i].address < 0) || (image->sections[i].size < 0) ||
+            ((unsigned long)image->sections[i].address + image->sections[i].size >
+             OBJECT_FORMAT_ADDRESS_SPACE))
+            return OBJECT_FORMAT_OUT_OF_RANGE;
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Write an object image to a file. The text and data sections must have their address,
+ * size and words set, and the BSS section its address and size. File offsets and CRCs are
+ * computed here and stored back in the image. Nothing is written for an image which does
+ * not fit the address space.
+ * @param fp Output file, opened in binary mode.
+ * @param image Image to be written.
+ * @return OBJECT_FORMAT_OK, OBJECT_FORMAT_OUT_OF_RANGE or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_write(FILE *fp, object_image_t *image)
+{
+    unsigned char header[OBJECT_FORMAT_CONTENTS_OFFSET];
+    object_section_t *section;
+    unsigned long offset = OBJECT_FORMAT_CONTENTS_OFFSET;
+    unsigned long tables_crc = 0;
+    int status;
+    int i;
+    
+    if ((status = object_format_check_sections(image)) != OBJECT_FORMAT_OK)
+        return status;
+    
+    /* Section contents follow the section table, with no contents for BSS */
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+    {
+        section = &image->sections[i];
+    
+        if (i == OBJECT_SECTION_BSS)
+        {
+            section->offset = 0;
+            section->crc = 0;
+        }
+        else
+        {
+            section->offset = offset;
+            section->crc = object_format_crc32_words(section->words, section->size);
+            offset += (unsigned long)section->size*OBJECT_FORMAT_WORD_SIZE;
+        }
+    }
+    
+    object_format_write_tables(NULL, image, &tables_crc);
+    object_format_encode_header(image, tables_crc, header);
+    
+    if (fwrite(header, sizeof(header), 1, fp) != 1)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    /* Section contents */
+    for (i = 0; i < OBJECT_SECTION_BSS; ++i)
+    {
+        status = object_format_write_words(fp, image->sections[i].words,
+                                           image->sections[i].size);
+        if (status != OBJECT_FORMAT_OK)
+            return status;
+    }
+    
+    /* Symbol, relocation and string tables */
+    tables_crc = 0;
+    return object_format_write_tables(fp, image, &tables_crc);
+}
+
+/**
+ * Create an object file to be written as a stream. Room for the header and the section
+ * table is reserved, since they are only known when closing.
+ * @param stream Stream to be opened.
+ * @param filename Name of the output file.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_open(object_stream_t *stream, const char *filename)
+{
+    unsigned char header[OBJECT_FORMAT_CONTENTS_OFFSET];
+    
+    stream->size = 0;
+    stream->is_dirty = 0;
+    stream->relocation_count = 0;
+    
+    if ((stream->relocations = tmpfile()) == NULL)
+    {
+        stream->fp = NULL;
+        return OBJECT_FORMAT_IO_ERROR;
+    }
+    
+    if ((stream->fp = fopen(filename, "w+b")) == NULL)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    memset(header, 0, sizeof(header));
+    if (fwrite(header, sizeof(header), 1, stream->fp) != 1)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Append words to the stream. They may stay in the standard I/O buffer until the stream
+ * is synchronised.
+ * @param stream Open stream.
+ * @param words Words to be appended.
+ * @param size Number of words.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_write(object_stream_t *stream, const obj_t *words, int size)
+{
+    if (size <= 0)
+        return OBJECT_FORMAT_OK;
+    
+    stream->size += size;
+    stream->is_dirty = 1;
+    return object_format_write_words(stream->fp, words, size);
+}
+
+/**
+ * Append a relocation entry to the temporary file of the stream.
+ * @param stream Open stream.
+ * @param address Address of the word holding an absolute address.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_add_relocation(object_stream_t *stream, int address)
+{
+    unsigned char entry[OBJECT_FORMAT_RELOCATION_ENTRY_SIZE];
+    
+    object_format_put_u32(entry, address);
+    if (fwrite(entry, OBJECT_FORMAT_RELOCATION_ENTRY_SIZE, 1, stream->relocations) != 1)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    ++stream->relocation_count;
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Flush buffered words to the file, so that positioned I/O sees them. It costs nothing
+ * when no word was appended since the last call.
+ * @param stream Open stream.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_sync(object_stream_t *stream)
+{
+    if (!stream->is_dirty)
+        return OBJECT_FORMAT_OK;
+    
+    stream->is_dirty = 0;
+    return (fflush(stream->fp) == 0) ? OBJECT_FORMAT_OK : OBJECT_FORMAT_IO_ERROR;
+}
+
+/**
+ * Overwrite a word already appended to the stream, without moving the append position.
+ * @param stream Open stream.
+ * @param position Word address.
+ * @param value New value.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_patch(object_stream_t *stream, int position, obj_t value)
+{
+    unsigned char buffer[OBJECT_FORMAT_WORD_SIZE];
+    
+    if (object_format_stream_sync(stream) != OBJECT_FORMAT_OK)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    object_format_put_u16(buffer, (unsigned long)value & 0xFFFF);
+    if (pwrite(fileno(stream->fp), buffer, OBJECT_FORMAT_WORD_SIZE,
+               OBJECT_FORMAT_CONTENTS_OFFSET + (long)position*OBJECT_FORMAT_WORD_SIZE) !=
+        OBJECT_FORMAT_WORD_SIZE)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Read back words already appended to the stream.
+ * @param stream Open stream.
+ * @param position Address of the first word.
+ * @param words Destination.
+ * @param size Number of words.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_read(object_stream_t *stream, int position, obj_t *words,
+                              int size)
+{
+    unsigned char buffer[256*OBJECT_FORMAT_WORD_SIZE];
+    long value;
+    int block;
+    int i;
+    
+    if (object_format_stream_sync(stream) != OBJECT_FORMAT_OK)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    while (size > 0)
+    {
+        block = (size < 256) ? size : 256;
+    
+        if (pread(fileno(stream->fp), buffer, block*OBJECT_FORMAT_WORD_SIZE,
+                  OBJECT_FORMAT_CONTENTS_OFFSET + (long)position*OBJECT_FORMAT_WORD_SIZE) !=
+            block*OBJECT_FORMAT_WORD_SIZE)
+            return OBJECT_FORMAT_IO_ERROR;
+    
+        for (i = 0; i < block; ++i)
+        {
+            value = object_format_get_u16(&buffer[i*OBJECT_FORMAT_WORD_SIZE]);
+            words[i] = (obj_t)((value >= 0x8000) ? value - 0x10000 : value);
+        }
+    
+        words += block;
+        position += block;
+        size -= block;
+    }
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * CRC-32 of words already appended to the stream, as they are stored in the file.
+ * @param stream Open stream.
+ * @param position Address of the first word.
+ * @param size Number of words.
+ * @param crc Pointer to receive the CRC.
+ * @return OBJECT_FORMAT_OK or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_crc32(object_stream_t *stream, int position, int size,
+                               unsigned long *crc)
+{
+    unsigned char buffer[4096];
+    long offset = OBJECT_FORMAT_CONTENTS_OFFSET + (long)position*OBJECT_FORMAT_WORD_SIZE;
+    long length = (long)size*OBJECT_FORMAT_WORD_SIZE;
+    long block;
+    
+    *crc = 0;
+    if (object_format_stream_sync(stream) != OBJECT_FORMAT_OK)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    while (length > 0)
+    {
+        block = (length < (long)sizeof(buffer)) ? length : (long)sizeof(buffer);
+    
+        if (pread(fileno(stream->fp), buffer, block, offset) != block)
+            return OBJECT_FORMAT_IO_ERROR;
+    
+        *crc = object_format_crc32(*crc, buffer, block);
+        offset += block;
+        length -= block;
+    }
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Finish a stream. The words appended so far are the image, from address zero, with the
+ * text and data sections stored in place and BSS following them. The CRCs of the sections
+ * are computed by reading them back, then the tables are appended and the header is
+ * written over the reserved room.
+ * The relocations are the ones appended to the stream.
+ * @param stream Open stream, which is closed even on errors.
+ * @param image Image with the section addresses and sizes and symbols.
+ * @return OBJECT_FORMAT_OK, OBJECT_FORMAT_OUT_OF_RANGE or OBJECT_FORMAT_IO_ERROR.
+ */
+int object_format_stream_close(object_stream_t *stream, object_image_t *image)
+{
+    unsigned char header[OBJECT_FORMAT_CONTENTS_OFFSET];
+    object_section_t *section;
+    unsigned long tables_crc = 0;
+    int status = object_format_check_sections(image);
+    int i;
+    
+    for (i = 0; (i < OBJECT_SECTION_BSS) && (status == OBJECT_FORMAT_OK); ++i)
+    {
+        section = &image->sections[i];
+        section->offset = OBJECT_FORMAT_CONTENTS_OFFSET +
+                          (unsigned long)section->address*OBJECT_FORMAT_WORD_SIZE;
+        status = object_format_stream_crc32(stream, section->address, section->size,
+                                            &section->crc);
+    }
+    
+    image->sections[OBJECT_SECTION_BSS].offset = 0;
+    image->sections[OBJECT_SECTION_BSS].crc = 0;
+    image->relocations = NULL;
+    image->relocation_count = stream->relocation_count;
+    image->relocation_file = stream->relocations;
+    
+    if (status == OBJECT_FORMAT_OK)
+        status = object_format_write_tables(stream->fp, image, &tables_crc);
+    
+    if ((status == OBJECT_FORMAT_OK) && (fflush(stream->fp) != 0))
+        status = OBJECT_FORMAT_IO_ERROR;
+    
+    if (status == OBJECT_FORMAT_OK)
+    {
+        object_format_encode_header(image, tables_crc, header);
+        if (pwrite(fileno(stream->fp), header, sizeof(header), 0) != sizeof(header))
+            status = OBJECT_FORMAT_IO_ERROR;
+    }
+    
+    if ((fclose(stream->fp) != 0) && (status == OBJECT_FORMAT_OK))
+        status = OBJECT_FORMAT_IO_ERROR;
+    
+    stream->fp = NULL;
+    image->relocation_file = NULL;
+    object_format_stream_abort(stream);
+    return status;
+}
+
+/**
+ * Give up a stream, closing its files. The temporary file of the relocation entries is
+ * removed once closed. Does nothing for files already closed.
+ * @param stream Stream, open or not.
+ */
+void object_format_stream_abort(object_stream_t *stream)
+{
+    if (stream->fp)
+    {
+        fclose(stream->fp);
+        stream->fp = NULL;
+    }
+    
+    if (stream->relocations)
+    {
+        fclose(stream->relocations);
+        stream->relocations = NULL;
+    }
+}
+
+/**
+ * Map an object file to memory, read-only. Files too short to hold a header or too large
+ * for the 32-bit offsets are refused before mapping. The mapping must be released with
+ * object_format_unmap.
+ * @param filename Name of the file.
+ * @param mapping Mapping to be filled.
+ * @return OBJECT_FORMAT_OK, OBJECT_FORMAT_IO_ERROR, OBJECT_FORMAT_TRUNCATED or
+ *         OBJECT_FORMAT_OVERSIZED.
+ */
+int object_format_map(const char *filename, object_mapping_t *mapping)
+{
+    struct stat file_stat;
+    void *data;
+    int fd;
+    
+    mapping->data = NULL;
+    mapping->length = 0;
+    
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return OBJECT_FORMAT_IO_ERROR;
+    }
+    
+    if (file_stat.st_size < OBJECT_FORMAT_CONTENTS_OFFSET)
+    {
+        close(fd);
+        return OBJECT_FORMAT_TRUNCATED;
+    }
+    
+    if ((unsigned long)file_stat.st_size > OBJECT_FORMAT_MAX_FILE_SIZE)
+    {
+        close(fd);
+        return OBJECT_FORMAT_OVERSIZED;
+    }
+    
+    data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* The mapping stays valid after closing the file */
+    
+    if (data == MAP_FAILED)
+        return OBJECT_FORMAT_IO_ERROR;
+    
+    mapping->data = data;
+    mapping->length = file_stat.st_size;
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Release a mapping created by object_format_map.
+ * @param mapping Mapping to be released.
+ */
+void object_format_unmap(object_mapping_t *mapping)
+{
+    if (mapping->data)
+        munmap((void*)mapping->data, mapping->length);
+    
+    mapping->data = NULL;
+    mapping->length = 0;
+}
+
+/**
+ * Parse and validate an object file held in memory. The image keeps pointers to the
+ * buffer, which must outlive it. Every section and table is bounds checked and its CRC is
+ * verified, so later accesses to the image need no further checking.
+ * @param buffer Object file contents.
+ * @param length Buffer length, in bytes.
+ * @param image Image to be filled.
+ * @return OBJECT_FORMAT_OK or the reason the file was rejected.
+ */
+int object_format_parse(const unsigned char *buffer, unsigned long length,
+                        object_image_t *image)
+{
+    const unsigned long header_size = OBJECT_FORMAT_CONTENTS_OFFSET;
+    const unsigned char *entry;
+    object_section_t *section;
+    unsigned long address, size, offset, crc, tables_crc;
+    unsigned long symbol_count, relocation_count;
+    unsigned long position;
+    int image_size;
+    int i;
+    
+    object_format_init(image);
+    
+    if (length < header_size)
+        return OBJECT_FORMAT_TRUNCATED;
+    
+    if (memcmp(buffer, OBJECT_FORMAT_MAGIC, 4) != 0)
+        return OBJECT_FORMAT_BAD_MAGIC;
+    
+    image->version = object_format_get_u16(buffer + 4);
+    if (image->version != OBJECT_FORMAT_VERSION)
+        return OBJECT_FORMAT_BAD_VERSION;
+    
+    image->flags = object_format_get_u16(buffer + 6);
+    if (object_format_get_u32(buffer + 12) != OBJECT_SECTION_COUNT)
+        return OBJECT_FORMAT_BAD_SECTION;
+    
+    symbol_count = object_format_get_u32(buffer + 16);
+    relocation_count = object_format_get_u32(buffer + 20);
+    image->strings_size = object_format_get_u32(buffer + 24);
+    tables_crc = object_format_get_u32(buffer + 28);
+    
+    /* Sections. Addresses must fit the 16-bit address space. */
+    position = header_size;
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+    {
+        section = &image->sections[i];
+        entry = buffer + OBJECT_FORMAT_HEADER_SIZE + i*OBJECT_FORMAT_SECTION_ENTRY_SIZE;
+        address = object_format_get_u32(entry + 4);
+        size = object_format_get_u32(entry + 8);
+        offset = object_format_get_u32(entry + 12);
+        crc = object_format_get_u32(entry + 16);
+    
+        if ((object_format_get_u32(entry) != (unsigned long)i) ||
+            (address >= OBJECT_FORMAT_ADDRESS_SPACE) ||
+            (size > OBJECT_FORMAT_ADDRESS_SPACE - address))
+            return OBJECT_FORMAT_BAD_SECTION;
+    
+        section->address = address;
+        section->size = size;
+        section->offset = offset;
+        section->crc = crc;
+    
+        if (i == OBJECT_SECTION_BSS)
+        {
+            if ((offset != 0) || (crc != 0))
+                return OBJECT_FORMAT_BAD_SECTION;
+            continue;
+        }
+    
+        if ((offset < header_size) || (offset > length) ||
+            (size > (length - offset)/OBJECT_FORMAT_WORD_SIZE))
+            return OBJECT_FORMAT_TRUNCATED;
+    
+        section->data = buffer + offset;
+        if (object_format_crc32(0, section->data, size*OBJECT_FORMAT_WORD_SIZE) != crc)
+            return OBJECT_FORMAT_BAD_CHECKSUM;
+    
+        if (offset + size*OBJECT_FORMAT_WORD_SIZE > position)
+            position = offset + size*OBJECT_FORMAT_WORD_SIZE;
+    }
+    
+    address = object_format_get_u32(buffer + 8);
+    section = &image->sections[OBJECT_SECTION_TEXT];
+    if ((address < (unsigned long)section->address) ||
+        (address > (unsigned long)(section->address + section->size)))
+        return OBJECT_FORMAT_BAD_SECTION;
+    image->entry = address;
+    
+    /* Tables follow the section contents */
+    if (symbol_count > (length - position)/OBJECT_FORMAT_SYMBOL_ENTRY_SIZE)
+        return OBJECT_FORMAT_TRUNCATED;
+    image->symbol_data = buffer + position;
+    image->symbol_count = symbol_count;
+    
+    if (relocation_count > (length - position - symbol_count*OBJECT_FORMAT_SYMBOL_ENTRY_SIZE)/
+                           OBJECT_FORMAT_RELOCATION_ENTRY_SIZE)
+        return OBJECT_FORMAT_TRUNCATED;
+    image->relocation_data = image->symbol_data +
+                             symbol_count*OBJECT_FORMAT_SYMBOL_ENTRY_SIZE;
+    image->relocation_count = relocation_count;
+    
+    image->strings = (const char*)(image->relocation_data +
+                                   relocation_count*OBJECT_FORMAT_RELOCATION_ENTRY_SIZE);
+    offset = (const unsigned char*)image->strings - buffer;
+    if (image->strings_size > length - offset)
+        return OBJECT_FORMAT_TRUNCATED;
+    if (image->strings_size != length - offset)
+        return OBJECT_FORMAT_OVERSIZED;
+    
+    if (object_format_crc32(0, buffer + position, length - position) != tables_crc)
+        return OBJECT_FORMAT_BAD_CHECKSUM;
+    
+    if ((image->strings_size > 0) && (image->strings[image->strings_size - 1] != '\0'))
+        return OBJECT_FORMAT_BAD_TABLE;
+    
+    for (i = 0; i < image->symbol_count; ++i)
+    {
+        entry = image->symbol_data + i*OBJECT_FORMAT_SYMBOL_ENTRY_SIZE;
+    
+        if ((object_format_get_u32(entry) >= image->strings_size) ||
+            (object_format_get_u32(entry + 8) >= OBJECT_SECTION_COUNT))
+            return OBJECT_FORMAT_BAD_TABLE;
+    }
+    
+    image_size = object_format_image_size(image);
+    for (i = 0; i < image->relocation_count; ++i)
+        if (object_format_get_relocation(image, i) >= (unsigned long)image_size)
+            return OBJECT_FORMAT_BAD_TABLE;
+    
+    return OBJECT_FORMAT_OK;
+}
+
+/**
+ * Get a symbol from a parsed image.
+ * @param image Parsed image.
+ * @param index Symbol index, less than the symbol count.
+ * @param symbol Pointer to receive the symbol. Its name points to the image buffer.
+ * @return Symbol value.
+ */
+int object_format_get_symbol(const object_image_t *image, int index,
+                             object_symbol_t *symbol)
+{
+    const unsigned char *entry = image->symbol_data + index*OBJECT_FORMAT_SYMBOL_ENTRY_SIZE;
+    
+    symbol->name = image->strings + object_format_get_u32(entry);
+    symbol->value = object_format_get_u32(entry + 4);
+    symbol->section = object_format_get_u32(entry + 8);
+    symbol->flags = object_format_get_u32(entry + 12);
+    
+    return symbol->value;
+}
+
+/**
+ * Get a relocation from a parsed image.
+ * @param image Parsed image.
+ * @param index Relocation index, less than the relocation count.
+ * @return Address of the word holding an absolute address, unsigned as stored, so that
+ *         no entry can pass a bounds check by turning negative.
+ */
+unsigned long object_format_get_relocation(const object_image_t *image, int index)
+{
+    return object_format_get_u32(image->relocation_data +
+                                 index*OBJECT_FORMAT_RELOCATION_ENTRY_SIZE);
+}
+
+/**
+ * Get the words of a section directly from the file buffer, with no copy. It is only
+ * possible when the host stores words in little-endian order and the contents are
+ * aligned, which always happens for mapped files written by object_format_write.
+ * @param image Parsed image.
+ * @param type Section type, either text or data.
+ * @return Pointer to the words or NULL, when the section must be decoded instead.
+ */
+const obj_t* object_format_section_words(const object_image_t *image, int type)
+{
+    const unsigned short probe = 1;
+    const unsigned char *data = image->sections[type].data;
+    
+    if ((sizeof(obj_t) != OBJECT_FORMAT_WORD_SIZE) || (*(const unsigned char*)&probe != 1) ||
+        (data == NULL) || ((unsigned long)data % sizeof(obj_t) != 0))
+        return NULL;
+    
+    return (const obj_t*)data;
+}
+
+/**
+ * Decode the contents of a section from a parsed image, with a single copy when the words
+ * can be used directly. BSS is zero-filled.
+ * @param image Parsed image.
+ * @param type Section type.
+ * @param destination Words receiving the section, with at least its size.
+ */
+void object_format_load_section(const object_image_t *image, int type, obj_t *destination)
+{
+    const object_section_t *section = &image->sections[type];
+    const obj_t *words;
+    long value;
+    int i;
+    
+    if (type == OBJECT_SECTION_BSS)
+    {
+        memset(destination, 0, sizeof(obj_t)*section->size);
+        return;
+    }
+    
+    if ((words = object_format_section_words(image, type)) != NULL)
+    {
+        memcpy(destination, words, sizeof(obj_t)*section->size);
+        return;
+    }
+    
+    for (i = 0; i < section->size; ++i)
+    {
+        value = object_format_get_u16(section->data + i*OBJECT_FORMAT_WORD_SIZE);
+        destination[i] = (obj_t)((value >= 0x8000) ? value - 0x10000 : value);
+    }
+}
+
+/**
+ * Number of words needed to load an image, which is the end of its last section.
+ * @param image Parsed image.
+ * @return Image size, in words.
+ */
+int object_format_image_size(const object_image_t *image)
+{
+    int size = 0;
+    int i;
+    
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+        if (image->sections[i].address + image->sections[i].size > size)
+            size = image->sections[i].address + image->sections[i].size;
+    
+    return size;
+}
+
+/**
+ * Describe a status returned by the reader and writer functions.
+ * @param status Status code.
+ * @return Constant message.
+ */
+const char* object_format_strerror(int status)
+{
+    switch (status)
+    {
+        case OBJECT_FORMAT_OK:
+            return "No error";
+        case OBJECT_FORMAT_IO_ERROR:
+            return "Could not read or write the file";
+        case OBJECT_FORMAT_TRUNCATED:
+            return "Truncated object file";
+        case OBJECT_FORMAT_OVERSIZED:
+            return "Object file is larger than its contents";
+        case OBJECT_FORMAT_BAD_MAGIC:
+            return "Not an object file";
+        case OBJECT_FORMAT_BAD_VERSION:
+            return "Unsupported object file version";
+        case OBJECT_FORMAT_BAD_SECTION:
+            return "Invalid section table";
+        case OBJECT_FORMAT_BAD_TABLE:
+            return "Invalid symbol, relocation or string table";
+        case OBJECT_FORMAT_BAD_CHECKSUM:
+            return "Checksum mismatch";
+        case OBJECT_FORMAT_OUT_OF_RANGE:
+            return "Program does not fit the 16-bit address space";
+        default:
+            return "Unknown error";
+    }
+}
@@ -0,0 +1,218 @@
+/**
+ * @file   object_format.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Reader and writer for the sectioned object file format
+ *
+ * This module is shared by the assembler and the simulator, so it depends only on the
+ * standard library. All fields are stored as little-endian unsigned integers, regardless
+ * of the host byte order. Addresses and sizes are given in words.
+ *
+ *  ------------------------------------------------------------------------------
+ * | Header (32 bytes)                                                            |
+ * |   4 bytes magic "SBOB" | 2 bytes version | 2 bytes flags | 4 bytes entry     |
+ * |   4 bytes section count | 4 bytes symbol count | 4 bytes relocation count    |
+ * |   4 bytes string table size | 4 bytes CRC of the symbol, relocation and      |
+ * |   string tables                                                              |
+ * |------------------------------------------------------------------------------|
+ * | Section table: one 20 bytes entry for text, data and BSS, in this order      |
+ * |   4 bytes type | 4 bytes address | 4 bytes size | 4 bytes file offset |      |
+ * |   4 bytes CRC of the contents                                                |
+ * |------------------------------------------------------------------------------|
+ * | Text contents (2 bytes per word) | Data contents (2 bytes per word)          |
+ * |------------------------------------------------------------------------------|
+ * | Symbol table: one 16 bytes entry per symbol                                  |
+ * |   4 bytes name offset in the string table | 4 bytes value |                  |
+ * |   4 bytes section type | 4 bytes flags                                       |
+ * |------------------------------------------------------------------------------|
+ * | Relocation table: 4 bytes address of each word holding an absolute address  |
+ * |------------------------------------------------------------------------------|
+ * | String table: null-terminated symbol names                                   |
+ *  ------------------------------------------------------------------------------
+ *
+ * The BSS section has no contents in the file: loaders must zero-fill it. Section contents
+ * may be stored in any order, at any offset after the section table, as long as the
+ * tables follow the last of them.
+ */
+
+#ifndef _OBJECT_FORMAT_H_
+#define _OBJECT_FORMAT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Object file has one word elements */
+typedef short int obj_t;
+
+#define OBJECT_FORMAT_MAGIC "SBOB"
+#define OBJECT_FORMAT_VERSION 1
+#define OBJECT_FORMAT_HEADER_SIZE 32
+#define OBJECT_FORMAT_SECTION_ENTRY_SIZE 20
+#define OBJECT_FORMAT_SYMBOL_ENTRY_SIZE 16
+#define OBJECT_FORMAT_RELOCATION_ENTRY_SIZE 4
+#define OBJECT_FORMAT_WORD_SIZE 2
+
+/* Number of addressable words. Every section must end within the address space. */
+#define OBJECT_FORMAT_ADDRESS_SPACE 0x10000UL
+
+/* Largest file accepted by the loader, since offsets and counts are 32-bit */
+#define OBJECT_FORMAT_MAX_FILE_SIZE 0x7FFFFFFFUL
+
+/* Header flags */
+#define OBJECT_FORMAT_HAS_SYMBOLS 0x1
+
+/* Symbol flags */
+#define OBJECT_SYMBOL_CONSTANT 0x1
+
+/**
+ * Sections available in an object file. The value is also the index in the section table.
+ */
+typedef enum
+{
+    OBJECT_SECTION_TEXT,
+    OBJECT_SECTION_DATA,
+    OBJECT_SECTION_BSS,
+    OBJECT_SECTION_COUNT
+} object_section_type_t;
+
+/* Section contents start right after the header and the section table */
+#define OBJECT_FORMAT_CONTENTS_OFFSET (OBJECT_FORMAT_HEADER_SIZE + \
+                                       OBJECT_SECTION_COUNT*OBJECT_FORMAT_SECTION_ENTRY_SIZE)
+
+/**
+ * Status returned by the reader and writer functions.
+ */
+typedef enum
+{
+    OBJECT_FORMAT_OK,
+    OBJECT_FORMAT_IO_ERROR,
+    OBJECT_FORMAT_TRUNCATED,
+    OBJECT_FORMAT_OVERSIZED,
+    OBJECT_FORMAT_BAD_MAGIC,
+    OBJECT_FORMAT_BAD_VERSION,
+    OBJECT_FORMAT_BAD_SECTION,
+    OBJECT_FORMAT_BAD_TABLE,
+    OBJECT_FORMAT_BAD_CHECKSUM,
+    OBJECT_FORMAT_OUT_OF_RANGE
+} object_format_status_t;
+
+/**
+ * A section of the program image. When writing, words points to the section contents.
+ * When reading, data points to the little-endian contents inside the file buffer.
+ */
+typedef struct
+{
+    int address;
+    int size;
+    unsigned long offset;
+    unsigned long crc;
+    const obj_t *words;
+    const unsigned char *data;
+} object_section_t;
+
+/**
+ * A read-only memory mapping of an object file.
+ */
+typedef struct
+{
+    const unsigned char *data;
+    unsigned long length;
+} object_mapping_t;
+
+/**
+ * An object file written as a stream of words, in address order. Words already written
+ * can be patched or read back with positioned I/O. The header is written when closing.
+ * Relocation entries are appended, already encoded, to a temporary file, and copied into
+ * the relocation table when closing, so they are not kept in memory either.
+ */
+typedef struct
+{
+    FILE *fp;
+    int size;
+    int is_dirty;
+    FILE *relocations;
+    int relocation_count;
+} object_stream_t;
+
+/**
+ * A symbol, with its value, the section it points to and flags.
+ */
+typedef struct
+{
+    const char *name;
+    int value;
+    int section;
+    int flags;
+} object_symbol_t;
+
+/**
+ * An object file image. The writer reads symbols and relocations from the arrays, or the
+ * encoded relocation entries from relocation_file when it is set. The reader leaves them
+ * NULL and keeps pointers to the raw tables in the file buffer, which are accessed with
+ * object_format_get_symbol and object_format_get_relocation.
+ */
+typedef struct
+{
+    int version;
+    int flags;
+    int entry;
+    object_section_t sections[OBJECT_SECTION_COUNT];
+
+    const object_symbol_t *symbols;
+    int symbol_count;
+    const int *relocations;
+    int relocation_count;
+    FILE *relocation_file;
+
+    const unsigned char *symbol_data;
+    const unsigned char *relocation_data;
+    const char *strings;
+    unsigned long strings_size;
+} object_image_t;
+
+void object_format_init(object_image_t *image);
+void object_format_put_u16(unsigned char *buffer, unsigned long value);
+void object_format_put_u32(unsigned char *buffer, unsigned long value);
+unsigned long object_format_get_u16(const unsigned char *buffer);
+unsigned long object_format_get_u32(const unsigned char *buffer);
+unsigned long object_format_crc32(unsigned long crc, const unsigned char *data,
+                                  unsigned long length);
+unsigned long object_format_crc32_words(const obj_t *words, int size);
+int object_format_write_words(FILE *fp, const obj_t *words, int size);
+int object_format_write_tables(FILE *fp, const object_image_t *image, unsigned long *crc);
+int object_format_copy_relocations(FILE *fp, const object_image_t *image,
+                                   unsigned long *crc);
+void object_format_encode_header(const object_image_t *image, unsigned long tables_crc,
+                                 unsigned char *header);
+int object_format_check_sections(const object_image_t *image);
+int object_format_write(FILE *fp, object_image_t *image);
+int object_format_stream_open(object_stream_t *stream, const char *filename);
+int object_format_stream_write(object_stream_t *stream, const obj_t *words, int size);
+int object_format_stream_add_relocation(object_stream_t *stream, int address);
+int object_format_stream_sync(object_stream_t *stream);
+int object_format_stream_patch(object_stream_t *stream, int position, obj_t value);
+int object_format_stream_read(object_stream_t *stream, int position, obj_t *words,
+                              int size);
+int object_format_stream_crc32(object_stream_t *stream, int position, int size,
+                               unsigned long *crc);
+int object_format_stream_close(object_stream_t *stream, object_image_t *image);
+void object_format_stream_abort(object_stream_t *stream);
+int object_format_map(const char *filename, object_mapping_t *mapping);
+void object_format_unmap(object_mapping_t *mapping);
+int object_format_parse(const unsigned char *buffer, unsigned long length,
+                        object_image_t *image);
+int object_format_get_symbol(const object_image_t *image, int index,
+                             object_symbol_t *symbol);
+unsigned long object_format_get_relocation(const object_image_t *image, int index);
+const obj_t* object_format_section_words(const object_image_t *image, int type);
+void object_format_load_section(const object_image_t *image, int type, obj_t *destination);
+int object_format_image_size(const object_image_t *image);
+const char* object_format_strerror(int status);
+
+#endif /* _OBJECT_FORMAT_H_ */
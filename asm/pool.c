@@ -0,0 +1,144 @@
+/**
+ * @file   pool.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the work-stealing thread pool
+ *
+ * The calling thread is the first worker, so no thread sits idle waiting for the others.
+ * A worker whose thread cannot be started still has its queue emptied by the others,
+ * which steal every job of it.
+ */
+
+#include "pool.h"
+
+/**
+ * Run every job, from 0 to job_count - 1, on a number of workers. Returns once all jobs
+ * are done.
+ * @param job_count Number of jobs.
+ * @param worker_count Number of workers, including the calling thread.
+ * @param task Routine which runs a job, given its number, the index of the worker running
+ *             it and arg. It is called from many threads at once, but never from two at
+ *             once for the same worker index, which is below worker_count.
+ * @param arg Argument of task, shared by all jobs.
+ */
+void pool_run(int job_count, int worker_count, void (*task)(int, int, void*), void *arg)
+{
+    pool_t pool;
+    pool_worker_t *workers;
+    pthread_t *threads;
+    int *is_started;
+    int i;
+    
+    if (worker_count > job_count)
+        worker_count = job_count;
+    
+    if (worker_count < 1)
+        worker_count = 1;
+    
+    pool.queues = malloc(sizeof(pool_queue_t)*worker_count);
+    pool.worker_count = worker_count;
+    pool.task = task;
+    pool.arg = arg;
+    workers = malloc(sizeof(pool_worker_t)*worker_count);
+    threads = malloc(sizeof(pthread_t)*worker_count);
+    is_started = malloc(sizeof(int)*worker_count);
+    
+    if (!pool.queues || !workers || !threads || !is_started)
+        error(ERROR_THREAD, "Cannot allocate memory for thread pool");
+    
+    /* Give each worker an even range of jobs */
+    for (i = 0; i < worker_count; ++i)
+    {
+        pthread_mutex_init(&pool.queues[i].lock, NULL);
+        pool.queues[i].top = (int)((long)job_count*i/worker_count);
+        pool.queues[i].bottom = (int)((long)job_count*(i + 1)/worker_count);
+        workers[i].pool = &pool;
+        workers[i].index = i;
+    }
+    
+    for (i = 1; i < worker_count; ++i)
+        is_started[i] = (pthread_create(&threads[i], NULL, pool_work, &workers[i]) == 0);
+    
+    pool_work(&workers[0]);
+    
+    for (i = 1; i < worker_count; ++i)
+        if (is_started[i])
+            pthread_join(threads[i], NULL);
+    
+    for (i = 0; i < worker_count; ++i)
+        pthread_mutex_destroy(&pool.queues[i].lock);
+    
+    free(is_started);
+    free(threads);
+    free(workers);
+    free(pool.queues);
+}
+
+/**
+ * Run jobs until every queue is empty. Since no job is added while the pool runs, there is
+ * nothing left to do once nothing can be taken nor stolen.
+ * @param arg Pointer to a pool worker struct.
+ * @return NULL.
+ */
+void* pool_work(void *arg)
+{
+    pool_worker_t *worker = arg;
+    pool_t *pool = worker->pool;
+    int job;
+    
+    while (((job = pool_take(pool, worker->index)) != POOL_NO_JOB) ||
+           ((job = pool_steal(pool, worker->index)) != POOL_NO_JOB))
+        pool->task(job, worker->index, pool->arg);
+    
+    return NULL;
+}
+
+/**
+ * Take a job from the bottom of the own queue of a worker.
+ * @param pool Pointer to a pool struct.
+ * @param index Index of the worker.
+ * @return number of the job or POOL_NO_JOB if the queue is empty.
+ */
+int pool_take(pool_t *pool, int index)
+{
+    pool_queue_t *queue = &pool->queues[index];
+    int job = POOL_NO_JOB;
+    
+    pthread_mutex_lock(&queue->lock);
+    
+    if (queue->bottom > queue->top)
+        job = --queue->bottom;
+    
+    pthread_mutex_unlock(&queue->lock);
+    
+    return job;
+}
+
+/**
+ * Steal a job from the top of the queue of another worker, trying them in turn starting
+ * from the next one.
+ * @param pool Pointer to a pool struct.
+ * @param index Index of the stealing worker.
+ * @return number of the job or POOL_NO_JOB if every other queue is empty.
+ */
+int pool_steal(pool_t *pool, int index)
+{
+    pool_queue_t *queue;
+    int job = POOL_NO_JOB;
+    int i;
+    
+    for (i = 1; (i < pool->worker_count) && (job == POOL_NO_JOB); ++i)
+    {
+        queue = &pool->queues[(index + i) % pool->worker_count];
+        
+        pthread_mutex_lock(&queue->lock);
+        
+        if (queue->bottom > queue->top)
+            job = queue->top++;
+        
+        pthread_mutex_unlock(&queue->lock);
+    }
+    
+    return job;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file   pool.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the work-stealing thread pool
+ *
+ * The pool runs a fixed set of jobs, numbered from zero, on a number of worker threads.
+ * Each worker starts with its own contiguous range of jobs, kept in a double-ended queue.
+ * A worker takes jobs from the bottom of its own queue and, once it is empty, steals
+ * jobs from the top of the other queues. Workers which got cheap jobs thus help the ones
+ * which got expensive jobs, without a central queue every worker contends for.
+ *
+ * Example usage
+ *
+    void task(int job, int worker, void *arg)
+    {
+        printf("Worker %d running job %d of %s\n", worker, job, (char*)arg);
+    }
+    
+    pool_run(100, 4, task, "example");
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "error.h"
+
+/* Returned when a queue has no jobs left */
+#define POOL_NO_JOB -1
+
+/*
+ * A pool queue struct holds the jobs from top to bottom - 1 still waiting in a worker
+ * queue. Jobs are never added once the pool runs, so each queue only shrinks. Its lock is
+ * only contended when another worker steals from it.
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+} pool_queue_t;
+
+/*
+ * A pool struct contains the following fields:
+ * - queues: Queue of each worker.
+ * - worker_count: Number of workers.
+ * - task: Routine which runs a job, given its number, the index of its worker and arg.
+ * - arg: Argument of task, shared by all jobs.
+ */
+typedef struct
+{
+    pool_queue_t *queues;
+    int worker_count;
+    void (*task)(int, int, void*);
+    void *arg;
+} pool_t;
+
+/**
+ * A worker of a pool, which is the argument of its thread.
+ */
+typedef struct
+{
+    pool_t *pool;
+    int index;
+} pool_worker_t;
+
+void pool_run(int job_count, int worker_count, void (*task)(int, int, void*), void *arg);
+void* pool_work(void *arg);
+int pool_take(pool_t *pool, int index);
+int pool_steal(pool_t *pool, int index);
+
+#endif /* _POOL_H_ */
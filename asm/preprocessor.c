@@ -6,242 +6,694 @@
  *
  * @brief  Implements pre-processing
  *
- * The preprocessing is implemented with a two-pass algorithm. The first pass only detects
- * equate directives and build an equate table with its value. The second pass removes
- * comments, replaces the equates labels and evaluate the if conditions.
- * Also, it makes everything case-insensitive by forcing the whole source code to
- * uppercase.
+ * The preprocessing reads and scans the source only once, keeping a record of each line.
+ * Equate directives are collected while scanning, so an equate may be used before its
+ * definition: substitutions are only resolved when the assembler asks for the lines,
+ * after every equate is known. IF conditions are evaluated at the same time.
+ * Large sources are split into chunks at line boundaries, which are scanned in parallel.
+ * The line count of each chunk is taken first, and their prefix sum tells where the
+ * records of each chunk go, so the records end up in source order, just as if the source
+ * was scanned by a single thread. Only scanning runs in parallel: equates are then added
+ * in source order, and the assembler still encodes the lines one after the other, as the
+ * address of each line depends on every line before it.
+ * In pipelined mode, the source is read and scanned on a thread of its own instead,
+ * handing off batches of records through a ring buffer, and the assembler takes the
+ * preprocessed lines while the rest of the source is still being scanned. Only scanning
+ * overlaps assembling: the whole file is read first, as equates must be known before any
+ * line is resolved, and they are collected then, scanning only the few lines which may
+ * have an EQU directive.
+ * Also, it makes everything case-insensitive, since the scanner folds the whole source
+ * code to uppercase.
  */
 
 #include "preprocessor.h"
 
 /**
- * Preprocess a source code, generating a preprocessed output file.
+ * Preprocess a source code, keeping the preprocessed lines in memory for the assembler.
+ * The preprocessed output file is optional, for debugging.
+ * @param preprocessor Pointer to a preprocessor struct, which must be destroyed after
+ *                     assembling.
  * @param filename Input source code.
- * @param output Output preprocessed code.
+ * @param output Output preprocessed code, or NULL for not writing it.
+ * @param is_pipelined Whether to preprocess on another thread while assembling.
+ * @param is_listed Whether the lines are listed, which keeps a copy of the source as read.
  */
-void preprocess(char *filename, char *output)
+void preprocess(preprocessor_t *preprocessor, char *filename, char *output,
+                int is_pipelined, int is_listed)
 {
-    hash_table_t equate_table;
+    context_printf("===== Pre-processing =====\n");
     
-    printf("===== Pre-processing =====\n");
+    if (is_pipelined)
+    {
+        preprocessor_start(preprocessor, filename, output, is_listed);
+        return;
+    }
+    
+    preprocessor_init(preprocessor, filename);
+    
+    if (is_listed)
+        source_keep_original(&preprocessor->source);
     
-    equate_table_init(&equate_table);
-    preprocessor_first_pass(filename, &equate_table);
-    preprocessor_second_pass(filename, output, &equate_table);
+    preprocessor_scan(preprocessor);
+    
+    if (output)
+    {
+        preprocessor_write(preprocessor, output);
+        preprocessor_rewind(preprocessor);
+    }
 }
 
 /**
- * First pass, detects equate directives and force the code to uppercase.
- * @param filename Input source file.
- * @param equate_table Allocated table to store the equate directives.
+ * Preprocess source code kept in memory, in the same way as preprocess does for a file.
+ * The preprocessed code is not written.
+ * @param preprocessor Pointer to a preprocessor struct.
+ * @param data Input source code, which does not need to be null-terminated.
+ * @param size Number of characters of the source code.
+ * @param chunk_count Number of chunks to scan the source in, up to
+ *                    PREPROCESSOR_MAX_CHUNKS, or 0 for choosing it from its size.
  */
-void preprocessor_first_pass(char *filename, hash_table_t *equate_table)
+void preprocess_buffer(preprocessor_t *preprocessor, const char *data, size_t size,
+                       int chunk_count)
 {
-    FILE *fp;
-    char line_buffer[FILE_LINE_LENGTH];
-    element_t elements;
+    context_printf("===== Pre-processing =====\n");
     
-    /* Open files */
-    fp = file_open(filename, "r");
+    preprocessor_init_tables(preprocessor);
+    preprocessor->chunk_count = chunk_count;
+    source_open_buffer(&preprocessor->source, data, size);
+    preprocessor_scan(preprocessor);
+}
+
+/**
+ * Read a source file and prepare its preprocessing.
+ * @param preprocessor Pointer to a preprocessor struct.
+ * @param filename Input source code.
+ */
+void preprocessor_init(preprocessor_t *preprocessor, char *filename)
+{
+    preprocessor_init_tables(preprocessor);
+    source_open(&preprocessor->source, filename);
+}
+
+/**
+ * Prepare the preprocessing, before its source is read. An error cleanup is pushed for the
+ * preprocessor, so it is released even if an error stops the assembly within an assembly
+ * context. Interned strings come from the arena of the context, if it has one.
+ * @param preprocessor Pointer to a preprocessor struct.
+ */
+void preprocessor_init_tables(preprocessor_t *preprocessor)
+{
+    interner_init_in_arena(&preprocessor->interner, context_arena());
+    equate_table_init(&preprocessor->equate_table);
+    
+    preprocessor->source.data = NULL;
+    preprocessor->source.original = NULL;
+    preprocessor->lines = malloc(sizeof(line_record_t)*PREPROCESSOR_INITIAL_CAPACITY);
+    preprocessor->line_count = 0;
+    preprocessor->line_capacity = PREPROCESSOR_INITIAL_CAPACITY;
+    preprocessor->chunk_count = 0;
+    preprocessor->is_pipelined = 0;
+    preprocessor_rewind(preprocessor);
+    
+    context_push_cleanup(preprocessor_cleanup, preprocessor);
+}
+
+/**
+ * Start preprocessing a source file in pipelined mode. The scanning stage runs on a thread
+ * of its own, until the assembler takes the last preprocessed line. The interner keeps its
+ * own arena, as the scanning thread interns while the assembler runs.
+ * @param preprocessor Pointer to a preprocessor struct.
+ * @param filename Input source code.
+ * @param output Output preprocessed code, or NULL for not writing it.
+ * @param is_listed Whether the lines are listed, which keeps a copy of the source as read.
+ */
+void preprocessor_start(preprocessor_t *preprocessor, char *filename, char *output,
+                        int is_listed)
+{
+    interner_init(&preprocessor->interner);
+    equate_table_init(&preprocessor->equate_table);
+    
+    preprocessor->lines = NULL;
+    preprocessor->line_count = 0;
+    preprocessor->line_capacity = 0;
+    preprocessor_rewind(preprocessor);
+    
+    preprocessor->is_pipelined = 1;
+    preprocessor->filename = filename;
+    preprocessor->output = output;
+    preprocessor->is_listed = is_listed;
+    preprocessor->batch = NULL;
+    preprocessor->batch_position = 0;
+    preprocessor->is_finished = 0;
     
-    /* Detect EQU directives */
-    while(file_read_line(fp, line_buffer) != FILE_FINISHED)
+    ring_init(&preprocessor->record_ring, sizeof(record_batch_t),
+              PREPROCESSOR_RING_CAPACITY);
+    
+    if (pthread_create(&preprocessor->scan_thread, NULL, preprocessor_scan_stage,
+                       preprocessor) != 0)
+        error(ERROR_THREAD, "Cannot start preprocessing thread");
+}
+
+/**
+ * Free all memory used by a preprocessor, including its source buffer.
+ * @param preprocessor Pointer to a preprocessor struct.
+ */
+void preprocessor_destroy(preprocessor_t *preprocessor)
+{
+    context_pop_cleanup(preprocessor);
+    
+    if (preprocessor->is_pipelined)
     {
-        remove_comments(line_buffer);
-        
-        /* Make it case insensitive by forcing everything to uppercase */
-        to_uppercase(line_buffer);
-        
-        if (detect_directive(&elements, line_buffer) == DIRECTIVE_EQU_NUMBER)
-            equate_table_add(equate_table, elements.label, elements.operand1);
-        
-        element_clear(&elements); /* So as one line does not interfere to the other */
+        pthread_join(preprocessor->scan_thread, NULL);
+        ring_destroy(&preprocessor->record_ring);
     }
     
-    /* Close files */
-    file_close(fp);
+    free(preprocessor->lines);
+    equate_table_destroy(&preprocessor->equate_table);
+    interner_destroy(&preprocessor->interner);
+    source_close(&preprocessor->source);
 }
 
 /**
- * Second pass, force the code to uppercase, remove comments, replace equate directives
- * and evaluate if cases. It must evaluate the equates before the if conditions.
- * For false IF cases, the next line must be ignored.
- * @param filename Input source file.
- * @param output Output preprocessed file.
- * @param equate_table Allocated table to store the equate directives.
+ * Error cleanup of a preprocessor.
+ * @param preprocessor Pointer to a preprocessor struct.
  */
-void preprocessor_second_pass(char *filename, char *output, hash_table_t *equate_table)
+void preprocessor_cleanup(void *preprocessor)
 {
-    FILE *fp;
-    FILE *fout;
-    char line_buffer[FILE_LINE_LENGTH];
-    element_t elements;
-    equate_t *equate;
-    int is_equate = 0;
-    int is_if = 0;
-    int is_if_false = 0;
+    preprocessor_destroy(preprocessor);
+}
+
+/**
+ * Scan every line of the source once, keeping its record and adding its equate directive
+ * to the equate table. Comments are left out of the line records.
+ * @param preprocessor Pointer to a preprocessor struct.
+ */
+void preprocessor_scan(preprocessor_t *preprocessor)
+{
+    source_line_t line;
+    line_record_t *record;
+    int chunk_count = preprocessor_chunk_count(preprocessor);
     
-    /* Open files */
-    fp = file_open(filename, "r");
-    fout = file_open(output, "w");
+    if (chunk_count > 1)
+    {
+        preprocessor_scan_parallel(preprocessor, chunk_count);
+        return;
+    }
     
-    while(file_read_line(fp, line_buffer) != FILE_FINISHED)
+    while (source_next_line(&preprocessor->source, &line))
     {
-        remove_comments(line_buffer);
-        
-        /* Make it case insensitive by forcing everything to uppercase */
-        to_uppercase(line_buffer);
-        
-        /* Replace EQU directives */
-        scan_line_elements(&elements, line_buffer);
-        equate = hash_search(equate_table, elements.operand1);
-        
-        if (equate)
-            replace(line_buffer, elements.operand1, equate->value);
-        
-        if (strcmp(elements.operation, "EQU") == 0)
-            is_equate = 1;
-            
-        element_clear(&elements); /* So as one line does not interfere to the other */
-        
-        /* Ignore line if IF directive was false */
-        if (is_if_false)
-        {
-            is_if_false = 0;
-            continue;
-        }
-        
-        /* Evaluate IF directives */
-        scan_line_elements(&elements, line_buffer);
-        
-        if (strcmp(elements.operation, "IF") == 0)
+        if (preprocessor->line_count == preprocessor->line_capacity)
         {
-            is_if = 1;
-            
-            /* Set flag if IF directive is evaluated as false */
-            if (!strtol(elements.operand1, NULL, 0))
-                is_if_false = 1;
-            
+            preprocessor->line_capacity *= 2;
+            preprocessor->lines = realloc(preprocessor->lines,
+                                          sizeof(line_record_t)*preprocessor->line_capacity);
         }
         
-        element_clear(&elements); /* So as one line does not interfere to the other */
+        record = &preprocessor->lines[preprocessor->line_count++];
+        scan_record(record, &line);
+        preprocessor_add_equate(preprocessor, record);
+    }
+}
+
+/**
+ * Get the number of chunks the source is scanned in: the one given to the preprocessor,
+ * if any, or else one for each processor, as long as each chunk has at least
+ * PREPROCESSOR_CHUNK_MIN_SIZE bytes.
+ * @param preprocessor Pointer to a preprocessor struct, with the source already read.
+ * @return Number of chunks, which is 1 for scanning the source sequentially.
+ */
+int preprocessor_chunk_count(preprocessor_t *preprocessor)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunk_count = preprocessor->source.size/PREPROCESSOR_CHUNK_MIN_SIZE;
+    
+    if (preprocessor->chunk_count > 0)
+        chunk_count = preprocessor->chunk_count;
+    else if ((processors > 0) && (chunk_count > (size_t)processors))
+        chunk_count = processors;
+    
+    if (chunk_count > PREPROCESSOR_MAX_CHUNKS)
+        chunk_count = PREPROCESSOR_MAX_CHUNKS;
+    
+    return (chunk_count < 1) ? 1 : (int)chunk_count;
+}
+
+/**
+ * Scan the source in chunks, in parallel. The equates are then added in source order,
+ * so the last definition of an equate label still takes effect.
+ * @param preprocessor Pointer to a preprocessor struct, with the source already read.
+ * @param chunk_count Number of chunks, from 2 to PREPROCESSOR_MAX_CHUNKS.
+ */
+void preprocessor_scan_parallel(preprocessor_t *preprocessor, int chunk_count)
+{
+    scan_chunk_t chunks[PREPROCESSOR_MAX_CHUNKS];
+    source_t *source = &preprocessor->source;
+    size_t start = 0;
+    size_t end;
+    char *newline;
+    int line_count = 0;
+    int i;
+    
+    /* Split the source after the first '\n' following each even split */
+    for (i = 0; i < chunk_count; ++i)
+    {
+        end = (i == chunk_count - 1) ? source->size : (source->size/chunk_count)*(i + 1);
         
-        /* Write line */
-        if (is_if)
+        if (end < start)
         {
-            is_if = 0;
-            continue;
+            end = start;
         }
-        
-        if (is_equate)
+        else if (end < source->size)
         {
-            is_equate = 0;
-            continue;
+            newline = memchr(source->data + end, '\n', source->size - end);
+            end = newline ? (size_t)(newline - source->data) + 1 : source->size;
         }
         
-        fprintf(fout, "%s", line_buffer);
+        chunks[i].source.data = source->data + start;
+        chunks[i].source.size = end - start;
+        source_rewind(&chunks[i].source);
+        start = end;
     }
     
-    /* Close files */
-    file_close(fp);
-    file_close(fout);
+    run_chunks(chunks, chunk_count, count_chunk_lines);
+    
+    /* Prefix sum of the line counts */
+    for (i = 0; i < chunk_count; ++i)
+    {
+        source_rewind(&chunks[i].source);
+        chunks[i].source.line_number = line_count;
+        line_count += chunks[i].line_count;
+    }
+    
+    if (line_count > preprocessor->line_capacity)
+    {
+        preprocessor->line_capacity = line_count;
+        preprocessor->lines = realloc(preprocessor->lines,
+                                      sizeof(line_record_t)*preprocessor->line_capacity);
+    }
+    
+    for (i = 0; i < chunk_count; ++i)
+        chunks[i].records = preprocessor->lines + chunks[i].source.line_number;
+    
+    run_chunks(chunks, chunk_count, scan_chunk);
+    preprocessor->line_count = line_count;
+    
+    for (i = 0; i < line_count; ++i)
+        preprocessor_add_equate(preprocessor, &preprocessor->lines[i]);
 }
 
 /**
- * Remove comments by placing "\n\0" to the position where a ";" is found.
- * @param line Line to have its comments removed.
+ * Run a routine for each chunk, each one on its own thread. The calling thread runs the
+ * routine for the first chunk, and for any chunk whose thread could not be started.
+ * @param chunks Chunks of the source.
+ * @param chunk_count Number of chunks.
+ * @param routine Routine taking a pointer to a chunk.
  */
-void remove_comments(char *line)
+void run_chunks(scan_chunk_t *chunks, int chunk_count, void* (*routine)(void*))
 {
+    pthread_t threads[PREPROCESSOR_MAX_CHUNKS];
+    int is_started[PREPROCESSOR_MAX_CHUNKS];
     int i;
     
-    for(i = 0; line[i] != '\0'; ++i)
+    for (i = 1; i < chunk_count; ++i)
+        is_started[i] = (pthread_create(&threads[i], NULL, routine, &chunks[i]) == 0);
+    
+    routine(&chunks[0]);
+    
+    for (i = 1; i < chunk_count; ++i)
     {
-        switch (line[i])
-        {
-            case ';':
-            case -1: /* This one is weird and appears on the last word of the file */
-                line[i] = '\n';
-                line[i+1] = '\0';
-                return;
-        }
+        if (is_started[i])
+            pthread_join(threads[i], NULL);
+        else
+            routine(&chunks[i]);
     }
 }
 
 /**
- * Detect whether a line has either an if or an equate directive, also storing the parsed
- * line to an element struct.
- * @param elements Store the parsed line.
- * @param line Line to be evaluated.
+ * Count the lines of a chunk.
+ * @param arg Pointer to a chunk.
+ * @return NULL.
  */
-int detect_directive(element_t *elements, char *line)
+void* count_chunk_lines(void *arg)
 {
-    scan_line_elements(elements, line);
+    scan_chunk_t *chunk = arg;
+    source_line_t line;
     
-    if (strcmp(elements->operation, "IF") == 0)
-        return DIRECTIVE_IF_NUMBER;
-    else if (strcmp(elements->operation, "EQU") == 0)
-        return DIRECTIVE_EQU_NUMBER;
+    chunk->line_count = 0;
     
-    return NO_DIRECTIVE;
+    while (source_next_line(&chunk->source, &line))
+        ++chunk->line_count;
+    
+    return NULL;
+}
+
+/**
+ * Scan every line of a chunk into its records.
+ * @param arg Pointer to a chunk.
+ * @return NULL.
+ */
+void* scan_chunk(void *arg)
+{
+    scan_chunk_t *chunk = arg;
+    source_line_t line;
+    line_record_t *record = chunk->records;
+    
+    while (source_next_line(&chunk->source, &line))
+        scan_record(record++, &line);
+    
+    return NULL;
 }
 
 /**
- * Replace a substring in a string by another one. Following the implementation found at:
- * http://creativeandcritical.net/str-replace-c/
- * @param str String that will have its elements replaced
- * @param old String to be replaced
- * @param new Replacing string
+ * Add the equate of a scanned line to the equate table, if it has an EQU directive.
+ * @param preprocessor Pointer to a preprocessor struct.
+ * @param record Record of the scanned line.
  */
-void replace(char *str, char *old, char *new)
+void preprocessor_add_equate(preprocessor_t *preprocessor, const line_record_t *record)
 {
-    char *ret;
-    char *r;
-    const char *p;
-    const char *q;
-    size_t oldlen = strlen(old);
-    size_t newlen = strlen(new);
-    size_t retlen;
-    size_t count;
+    if (record->directive == DIRECTIVE_EQU)
+        equate_table_add(&preprocessor->equate_table,
+                         interner_intern(&preprocessor->interner,
+                                         record->elements.label.ptr,
+                                         record->elements.label.length),
+                         &record->elements.operand1);
+}
 
-    if (oldlen != newlen)
+/**
+ * Collect the equates of the whole source buffer, in order, for the pipelined mode. Only
+ * lines with a 'Q', in either case, may have an EQU directive, so only those are scanned.
+ * The scanner folds them to uppercase, which scanning them again later does not change.
+ * @param preprocessor Pointer to a preprocessor struct, with the source already read.
+ */
+void preprocessor_collect_equates(preprocessor_t *preprocessor)
+{
+    char *p = preprocessor->source.data;
+    char *end = preprocessor->source.data + preprocessor->source.size;
+    char *newline;
+    source_line_t line;
+    line_record_t record;
+    
+    line.ptr = p;
+    line.number = 0;
+    
+    for (; p < end; ++p)
     {
-        for (count = 0, p = str; (q = strstr(p, old)) != NULL; p = q + oldlen)
-            count++;
+        if (*p == '\n')
+        {
+            line.ptr = p + 1;
+        }
+        else if ((*p | 0x20) == 'q')
+        {
+            newline = memchr(p, '\n', end - p);
+            
+            if (!newline)
+                newline = end;
             
-        /* This is undefined if p - str > PTRDIFF_MAX */
-        retlen = p - str + strlen(p) + count*(newlen - oldlen);
+            line.length = newline - line.ptr;
+            scan_record(&record, &line);
+            preprocessor_add_equate(preprocessor, &record);
+            
+            /* Skip to the end of the line */
+            p = newline;
+            line.ptr = newline + 1;
+        }
     }
-    else
+}
+
+/**
+ * Scan a source line into its record, leaving its comment out.
+ * @param record Stores the record of the line.
+ * @param line Source line.
+ */
+void scan_record(line_record_t *record, const source_line_t *line)
+{
+    element_init(&record->elements);
+    record->line = *line;
+    record->line.length = scan_line_elements(&record->elements, line->ptr, line->length);
+    record->directive = detect_directive(&record->elements);
+}
+
+/**
+ * Scanning stage of the pipelined mode. Read the whole source file and collect its
+ * equates, then scan its lines, preprocess them and hand off the records of the lines
+ * which are kept, in batches. The preprocessed output file is written here, when required.
+ * @param arg Pointer to the preprocessor struct.
+ * @return NULL.
+ */
+void* preprocessor_scan_stage(void *arg)
+{
+    preprocessor_t *preprocessor = arg;
+    record_batch_t *records;
+    source_line_t line;
+    line_record_t record;
+    FILE *fout = NULL;
+    
+    source_open(&preprocessor->source, preprocessor->filename);
+    
+    if (preprocessor->is_listed)
+        source_keep_original(&preprocessor->source);
+    
+    preprocessor_collect_equates(preprocessor);
+    
+    if (preprocessor->output)
+        fout = file_open(preprocessor->output, "w");
+    
+    records = ring_write_slot(&preprocessor->record_ring);
+    records->count = 0;
+    
+    while (source_next_line(&preprocessor->source, &line))
     {
-        retlen = strlen(str);
+        scan_record(&record, &line);
+        
+        if (!preprocessor_resolve(preprocessor, &record, &records->records[records->count]))
+            continue;
+        
+        if (fout)
+            write_line(fout, &record, &records->records[records->count]);
+        
+        if (++records->count == PREPROCESSOR_BATCH_SIZE)
+        {
+            records->is_last = 0;
+            ring_publish(&preprocessor->record_ring);
+            
+            records = ring_write_slot(&preprocessor->record_ring);
+            records->count = 0;
+        }
     }
+    
+    if (fout)
+        file_close(fout);
+    
+    records->is_last = 1;
+    ring_publish(&preprocessor->record_ring);
+    
+    return NULL;
+}
+
+/**
+ * Look for the equate of a token.
+ * @param preprocessor Pointer to a preprocessor struct.
+ * @param token Token which may be an equate label.
+ * @return pointer to the equate or NULL if the token is not an equate label.
+ */
+equate_t* preprocessor_find_equate(preprocessor_t *preprocessor, const span_t *token)
+{
+    if (span_is_empty(token))
+        return NULL;
+    
+    return equate_table_search(&preprocessor->equate_table,
+                               interner_find(&preprocessor->interner, token->ptr,
+                                             token->length));
+}
 
-    /* Could not allocate memory */
-    ret = malloc(retlen + 1);
+/**
+ * Go back to the first preprocessed line.
+ * @param preprocessor Pointer to a preprocessor struct.
+ */
+void preprocessor_rewind(preprocessor_t *preprocessor)
+{
+    preprocessor->next_line = 0;
+    preprocessor->is_if_false = 0;
+}
 
-    for (r = ret, p = str; (q = strstr(p, old)) != NULL; p = q + oldlen)
+/**
+ * Get the next preprocessed line.
+ * @param preprocessor Pointer to a preprocessor struct, after scanning the source.
+ * @param output Stores the record of the preprocessed line.
+ * @return 1 if a line was found or 0 after the last line.
+ */
+int preprocessor_next_line(preprocessor_t *preprocessor, line_record_t *output)
+{
+    line_record_t *record;
+    
+    if (preprocessor->is_pipelined)
+        return preprocessor_next_batched_line(preprocessor, output);
+    
+    while (preprocessor->next_line < preprocessor->line_count)
     {
-        /* This is undefined if q - p > PTRDIFF_MAX */
-        ptrdiff_t l = q - p;
-        memcpy(r, p, l);
-        r += l;
-        memcpy(r, new, newlen);
-        r += newlen;
+        record = &preprocessor->lines[preprocessor->next_line++];
+        
+        if (preprocessor_resolve(preprocessor, record, output))
+            return 1;
     }
     
-    strcpy(r, p);
-    strcpy(str, ret);
+    return 0;
 }
 
 /**
- * Convert a string to uppercase.
- * @param token String to be converted
+ * Preprocess a scanned line, replacing equate labels and evaluating IF directives.
+ * Lines with EQU or IF directives are left out. For false IF cases, the next line is left
+ * out as well.
+ * Equate labels are replaced in any operand, by replacing the whole token with the token
+ * of the equate value. The line view is left unchanged.
+ * @param preprocessor Pointer to a preprocessor struct, after collecting every equate.
+ * @param record Record of the line as scanned from the source.
+ * @param output Stores the record of the preprocessed line.
+ * @return 1 if the line is kept or 0 if it is left out.
  */
-void to_uppercase(char *token)
+int preprocessor_resolve(preprocessor_t *preprocessor, const line_record_t *record,
+                         line_record_t *output)
 {
-    int i;
-    for (i = 0; token[i] != '\0'; ++i)
-        token[i] = toupper(token[i]);
+    equate_t *equate;
+    
+    /* Ignore line if IF directive was false */
+    if (preprocessor->is_if_false)
+    {
+        preprocessor->is_if_false = 0;
+        return 0;
+    }
+    
+    if (record->directive == DIRECTIVE_EQU)
+        return 0;
+    
+    *output = *record;
+    
+    /* Replace EQU directives */
+    if ((equate = preprocessor_find_equate(preprocessor, &record->elements.operand1)))
+        output->elements.operand1 = equate->value;
+    
+    if ((equate = preprocessor_find_equate(preprocessor, &record->elements.operand2)))
+        output->elements.operand2 = equate->value;
+    
+    if (record->directive == DIRECTIVE_IF)
+    {
+        /* Set flag if IF directive is evaluated as false */
+        if (!output->elements.operand1.value)
+            preprocessor->is_if_false = 1;
+        
+        return 0;
+    }
+    
+    return 1;
+}
+
+/**
+ * Get the next preprocessed line in pipelined mode, from the batches handed off by the
+ * scanning stage. Each batch is handed back once all its lines were taken.
+ * @param preprocessor Pointer to a preprocessor struct, started in pipelined mode.
+ * @param output Stores the record of the preprocessed line.
+ * @return 1 if a line was found or 0 after the last line.
+ */
+int preprocessor_next_batched_line(preprocessor_t *preprocessor, line_record_t *output)
+{
+    while ((!preprocessor->batch) ||
+           (preprocessor->batch_position == preprocessor->batch->count))
+    {
+        if (preprocessor->is_finished)
+            return 0;
+        
+        if (preprocessor->batch)
+        {
+            preprocessor->is_finished = preprocessor->batch->is_last;
+            preprocessor->batch = NULL;
+            ring_release(&preprocessor->record_ring);
+            continue;
+        }
+        
+        preprocessor->batch = ring_read_slot(&preprocessor->record_ring);
+        preprocessor->batch_position = 0;
+    }
+    
+    *output = preprocessor->batch->records[preprocessor->batch_position++];
+    
+    return 1;
+}
+
+/**
+ * Write all preprocessed lines to a file.
+ * @param preprocessor Pointer to a preprocessor struct, after scanning the source.
+ * @param output Output preprocessed file.
+ */
+void preprocessor_write(preprocessor_t *preprocessor, char *output)
+{
+    FILE *fout;
+    line_record_t record;
+    
+    /* Open files */
+    fout = file_open(output, "w");
+    
+    while (preprocessor_next_line(preprocessor, &record))
+        write_line(fout, &preprocessor->lines[preprocessor->next_line - 1], &record);
+    
+    /* Close files */
+    file_close(fout);
+}
+
+/**
+ * Write a preprocessed line, copying the source line except for the operands which were
+ * replaced.
+ * @param fout Output preprocessed file.
+ * @param source_record Record of the line as scanned from the source.
+ * @param record Record of the preprocessed line.
+ */
+void write_line(FILE *fout, const line_record_t *source_record, const line_record_t *record)
+{
+    const char *p = source_record->line.ptr;
+    const char *end = source_record->line.ptr + source_record->line.length;
+    
+    p = write_operand(fout, p, &source_record->elements.operand1,
+                      &record->elements.operand1);
+    p = write_operand(fout, p, &source_record->elements.operand2,
+                      &record->elements.operand2);
+    
+    fwrite(p, 1, end - p, fout);
+    fputc('\n', fout);
+}
+
+/**
+ * Write the characters of a source line up to an operand, followed by the operand when it
+ * was replaced.
+ * @param fout Output preprocessed file.
+ * @param p Next character of the source line to be written.
+ * @param source_operand Operand as scanned from the source.
+ * @param operand Operand of the preprocessed line.
+ * @return Next character of the source line to be written.
+ */
+const char* write_operand(FILE *fout, const char *p, const span_t *source_operand,
+                          const span_t *operand)
+{
+    if (operand->ptr == source_operand->ptr)
+        return p;
+    
+    fwrite(p, 1, source_operand->ptr - p, fout);
+    fwrite(operand->ptr, 1, operand->length, fout);
+    
+    return source_operand->ptr + source_operand->length;
+}
+
+/**
+ * Detect whether a scanned line has either an if or an equate directive.
+ * @param elements Elements of the line.
+ * @return DIRECTIVE_IF, DIRECTIVE_EQU or DIRECTIVE_NONE for any other line.
+ */
+directive_t detect_directive(element_t *elements)
+{
+    directive_t directive;
+    
+    directive = directives_table_search(elements->operation.ptr,
+                                        elements->operation.length);
+    
+    if ((directive == DIRECTIVE_IF) || (directive == DIRECTIVE_EQU))
+        return directive;
+    
+    return DIRECTIVE_NONE;
 }
\ No newline at end of file
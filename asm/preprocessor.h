@@ -10,6 +10,9 @@
  * IF blocks, that are compiled when the flag is positive (diferente than zero).
  *
  * Also, it removes all comments from the source code.
+ *
+ * The source is read and scanned only once, into line records kept in memory, which are
+ * handed to the assembler without going through the preprocessed file.
  */
 
 #ifndef _PREPROCESSOR_H_
@@ -17,23 +20,145 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <stddef.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "file.h"
+#include "context.h"
+#include "source.h"
 #include "elements.h"
 #include "scanner.h"
+#include "directives_table.h"
+#include "interner.h"
 #include "equate_table.h"
+#include "ring.h"
+
+/* Initial capacity of the line records array */
+#define PREPROCESSOR_INITIAL_CAPACITY 256
+
+/* Smallest chunk of the source scanned by a thread of its own */
+#define PREPROCESSOR_CHUNK_MIN_SIZE (256*1024)
+
+/* Maximum number of chunks of the source scanned in parallel */
+#define PREPROCESSOR_MAX_CHUNKS 64
+
+/* Number of lines handed off at once from the scanning stage to the assembler */
+#define PREPROCESSOR_BATCH_SIZE 256
+
+/* Number of batches in the ring buffer of the scanning stage, a power of two */
+#define PREPROCESSOR_RING_CAPACITY 8
+
+/**
+ * Record of a scanned source line. The line view does not include comments, and both the
+ * line and its elements point into the source buffer.
+ */
+typedef struct
+{
+    source_line_t line;
+    element_t elements;
+    directive_t directive;
+} line_record_t;
+
+/**
+ * Chunk of the source buffer scanned by one thread. The source view starts at a line
+ * boundary and ends after a '\n' or at the end of the buffer. Its line number is set to
+ * the number of lines before the chunk, so its lines get their numbers in the whole
+ * source.
+ */
+typedef struct
+{
+    source_t source;
+    line_record_t *records;
+    int line_count;
+} scan_chunk_t;
+
+/**
+ * Batch of preprocessed line records, handed off from the scanning stage to the
+ * assembler. The last batch may have fewer records, or none.
+ */
+typedef struct
+{
+    line_record_t records[PREPROCESSOR_BATCH_SIZE];
+    int count;
+    int is_last;
+} record_batch_t;
+
+/*
+ * A preprocessor struct contains the following fields:
+ * - source: Source buffer, which holds the characters of all lines.
+ * - interner: Interner for the equate labels and values.
+ * - equate_table: Equates found in the source, indexed by label id.
+ * - lines: Record of each source line, in order.
+ * - line_count: Number of line records.
+ * - line_capacity: Number of line records allocated, which grows geometrically.
+ * - chunk_count: Number of chunks the source is scanned in, or 0 for choosing it from the
+ *                size of the source and the number of processors.
+ * - next_line: Index of the next line record to be preprocessed.
+ * - is_if_false: Whether the next line record must be ignored, after a false IF.
+ * - is_pipelined: Whether the source is read and scanned on a thread of its own, handing
+ *                 off batches through the ring buffer, while the assembler runs.
+ * - filename: Input source code, when pipelined.
+ * - output: Output preprocessed code, or NULL, when pipelined.
+ * - is_listed: Whether a copy of the source as read is kept for the listing, when
+ *              pipelined.
+ * - record_ring: Batches of line records, from the scanning stage to the assembler.
+ * - scan_thread: Thread of the scanning stage.
+ * - batch: Batch of line records being read by the assembler, or NULL.
+ * - batch_position: Index of the next line record in batch.
+ * - is_finished: Whether the assembler has read the last batch.
+ */
+typedef struct
+{
+    source_t source;
+    interner_t interner;
+    equate_table_t equate_table;
+    line_record_t *lines;
+    int line_count;
+    int line_capacity;
+    int chunk_count;
+    int next_line;
+    int is_if_false;
+    int is_pipelined;
+    char *filename;
+    char *output;
+    int is_listed;
+    ring_t record_ring;
+    pthread_t scan_thread;
+    record_batch_t *batch;
+    int batch_position;
+    int is_finished;
+} preprocessor_t;
 
-#define NO_DIRECTIVE 0
-#define DIRECTIVE_IF_NUMBER 1
-#define DIRECTIVE_EQU_NUMBER 2
-
-void preprocess(char *filename, char *output);
-void preprocessor_first_pass(char *filename, hash_table_t *equate_table);
-void preprocessor_second_pass(char *filename, char *output, hash_table_t *equate_table);
-void remove_comments(char *line);
-int detect_directive(element_t *elements, char *line);
-void replace(char *str, char *old, char *new);
-void to_uppercase(char *token);
+void preprocess(preprocessor_t *preprocessor, char *filename, char *output,
+                int is_pipelined, int is_listed);
+void preprocess_buffer(preprocessor_t *preprocessor, const char *data, size_t size,
+                       int chunk_count);
+void preprocessor_init(preprocessor_t *preprocessor, char *filename);
+void preprocessor_init_tables(preprocessor_t *preprocessor);
+void preprocessor_start(preprocessor_t *preprocessor, char *filename, char *output,
+                        int is_listed);
+void preprocessor_destroy(preprocessor_t *preprocessor);
+void preprocessor_cleanup(void *preprocessor);
+void preprocessor_scan(preprocessor_t *preprocessor);
+int preprocessor_chunk_count(preprocessor_t *preprocessor);
+void preprocessor_scan_parallel(preprocessor_t *preprocessor, int chunk_count);
+void run_chunks(scan_chunk_t *chunks, int chunk_count, void* (*routine)(void*));
+void* count_chunk_lines(void *arg);
+void* scan_chunk(void *arg);
+void preprocessor_add_equate(preprocessor_t *preprocessor, const line_record_t *record);
+void preprocessor_collect_equates(preprocessor_t *preprocessor);
+void scan_record(line_record_t *record, const source_line_t *line);
+void* preprocessor_scan_stage(void *arg);
+equate_t* preprocessor_find_equate(preprocessor_t *preprocessor, const span_t *token);
+void preprocessor_rewind(preprocessor_t *preprocessor);
+int preprocessor_next_line(preprocessor_t *preprocessor, line_record_t *output);
+int preprocessor_resolve(preprocessor_t *preprocessor, const line_record_t *record,
+                         line_record_t *output);
+int preprocessor_next_batched_line(preprocessor_t *preprocessor, line_record_t *output);
+void preprocessor_write(preprocessor_t *preprocessor, char *output);
+void write_line(FILE *fout, const line_record_t *source_record, const line_record_t *record);
+const char* write_operand(FILE *fout, const char *p, const span_t *source_operand,
+                          const span_t *operand);
+directive_t detect_directive(element_t *elements);
 
 #endif /* _PREPROCESSOR_H_ */
\ No newline at end of file
@@ -0,0 +1,108 @@
+/**
+ * @file   ring.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the single-producer single-consumer ring buffer
+ *
+ * C89 has no atomic operations, so the counters are accessed with the GCC atomic
+ * builtins. Each thread reads the counter of the other one with acquire ordering and
+ * writes its own with release ordering: a slot is only seen as published after its
+ * contents were written, and only reused after its contents were read.
+ */
+
+#include "ring.h"
+
+/**
+ * Init a ring buffer.
+ * @param ring Pointer to a ring struct.
+ * @param slot_size Size of each slot, in bytes.
+ * @param capacity Number of slots, which must be a power of two.
+ */
+void ring_init(ring_t *ring, size_t slot_size, unsigned long capacity)
+{
+    ring->slots = malloc(slot_size*capacity);
+    
+    if (!ring->slots)
+        error(ERROR_THREAD, "Cannot allocate memory for ring buffer");
+    
+    ring->slot_size = slot_size;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * Free the memory of a ring buffer. No thread may be using it anymore.
+ * @param ring Pointer to a ring struct.
+ */
+void ring_destroy(ring_t *ring)
+{
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/**
+ * Get the next slot to be written, waiting while the ring is full. Must only be called by
+ * the producer thread.
+ * @param ring Pointer to a ring struct.
+ * @return pointer to the slot, which is handed to the consumer by ring_publish.
+ */
+void* ring_write_slot(ring_t *ring)
+{
+    unsigned long head = ring->head;
+    int spins = 0;
+    
+    while (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask)
+        ring_wait(&spins);
+    
+    return ring->slots + (head & ring->mask)*ring->slot_size;
+}
+
+/**
+ * Hand the slot given by ring_write_slot to the consumer thread.
+ * @param ring Pointer to a ring struct.
+ */
+void ring_publish(ring_t *ring)
+{
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Get the next slot to be read, waiting while the ring is empty. Must only be called by
+ * the consumer thread.
+ * @param ring Pointer to a ring struct.
+ * @return pointer to the slot, which is handed back to the producer by ring_release.
+ */
+void* ring_read_slot(ring_t *ring)
+{
+    unsigned long tail = ring->tail;
+    int spins = 0;
+    
+    while (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail)
+        ring_wait(&spins);
+    
+    return ring->slots + (tail & ring->mask)*ring->slot_size;
+}
+
+/**
+ * Hand the slot given by ring_read_slot back to the producer thread.
+ * @param ring Pointer to a ring struct.
+ */
+void ring_release(ring_t *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Wait for the other thread. Busy-wait for a few checks, which is cheap when the other
+ * thread is about to finish a batch, and then yield the processor.
+ * @param spins Number of checks done so far.
+ */
+void ring_wait(int *spins)
+{
+    if (*spins < RING_SPIN_COUNT)
+        ++*spins;
+    else
+        sched_yield();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file   ring.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the single-producer single-consumer ring buffer
+ *
+ * The ring buffer hands off fixed-size slots from one thread to another without locks.
+ * Exactly one thread may write slots and exactly one thread may read them. Slots are
+ * filled and read in place, so nothing is copied between the threads.
+ *
+ * Example usage
+ *
+    ring_t ring;
+    int *slot;
+    
+    ring_init(&ring, sizeof(int), 8);
+    
+    slot = ring_write_slot(&ring);     (producer thread)
+    *slot = 42;
+    ring_publish(&ring);
+    
+    slot = ring_read_slot(&ring);      (consumer thread)
+    printf("%d\n", *slot);
+    ring_release(&ring);
+    
+    ring_destroy(&ring);
+ */
+
+#ifndef _RING_H_
+#define _RING_H_
+
+#include <stdlib.h>
+#include <sched.h>
+#include "error.h"
+
+/* Size of a cache line, so the producer and consumer counters do not share one */
+#define RING_CACHE_LINE 64
+
+/* Number of times a thread checks the other counter before yielding the processor */
+#define RING_SPIN_COUNT 64
+
+/*
+ * A ring struct contains the following fields:
+ * - slots: Memory for all slots, one after the other.
+ * - slot_size: Size of each slot, in bytes.
+ * - mask: Number of slots minus one. The number of slots is a power of two, so a counter
+ *         is turned into a slot index by masking.
+ * - head: Number of slots published by the producer. Only the producer changes it.
+ * - tail: Number of slots released by the consumer. Only the consumer changes it.
+ * The counters only grow, so the ring is empty when they are equal and full when they are
+ * apart by the number of slots.
+ */
+typedef struct
+{
+    char *slots;
+    size_t slot_size;
+    unsigned long mask;
+    char padding1[RING_CACHE_LINE];
+    unsigned long head;
+    char padding2[RING_CACHE_LINE];
+    unsigned long tail;
+    char padding3[RING_CACHE_LINE];
+} ring_t;
+
+void ring_init(ring_t *ring, size_t slot_size, unsigned long capacity);
+void ring_destroy(ring_t *ring);
+void* ring_write_slot(ring_t *ring);
+void ring_publish(ring_t *ring);
+void* ring_read_slot(ring_t *ring);
+void ring_release(ring_t *ring);
+void ring_wait(int *spins);
+
+#endif /* _RING_H_ */
@@ -0,0 +1,203 @@
+/**
+ * @file   sbasm.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the assembler library interface
+ *
+ * Each call runs within its own assembly context, whose diagnostics buffer collects the
+ * error messages. As in batch assembly, the preprocessor, the context and the buffer are
+ * allocated, so they keep their values after an error jumps back.
+ *
+ * The library header declares nothing but the interface, so the internal modules are
+ * included here. Every other symbol is kept local to the library when it is built.
+ */
+
+#include <string.h>
+#include <setjmp.h>
+#include "sbasm.h"
+#include "error.h"
+#include "context.h"
+#include "diagnostics.h"
+#include "preprocessor.h"
+#include "assembler.h"
+
+/* Initial capacity of the diagnostics array */
+#define SBASM_INITIAL_DIAGNOSTICS 4
+
+/*
+ * Error types of the assembler are returned as they are, so each SBASM_ERROR value must be
+ * the same as its error type. Otherwise, the array size is negative and this fails to
+ * compile.
+ */
+typedef char sbasm_error_types_check[((SBASM_ERROR_COMMAND_LINE == ERROR_COMMAND_LINE) &&
+                                      (SBASM_ERROR_FILE == ERROR_FILE) &&
+                                      (SBASM_ERROR_OBJECT_FILE == ERROR_OBJECT_FILE) &&
+                                      (SBASM_ERROR_SCANNER == ERROR_SCANNER) &&
+                                      (SBASM_ERROR_LEXICAL == ERROR_LEXICAL) &&
+                                      (SBASM_ERROR_SYNTACTIC == ERROR_SYNTACTIC) &&
+                                      (SBASM_ERROR_SEMANTIC == ERROR_SEMANTIC) &&
+                                      (SBASM_ERROR_THREAD == ERROR_THREAD)) ? 1 : -1];
+
+void sbasm_add_diagnostic(sbasm_result_t *result, const diagnostic_t *entry);
+
+/**
+ * Init the options of an assembly with their defaults.
+ * @param options Pointer to a sbasm options struct.
+ */
+void sbasm_options_init(sbasm_options_t *options)
+{
+    options->keep_progress = 0;
+    options->max_errors = 0;
+    options->scan_chunks = 0;
+}
+
+/**
+ * Assemble source code kept in memory. The result must be freed with sbasm_result_free,
+ * whether the assembly succeeded or not.
+ * @param src Source code, which does not need to be null-terminated.
+ * @param len Number of characters of the source code.
+ * @param options Pointer to a sbasm options struct, or NULL for the defaults.
+ * @param result Stores the object file and the diagnostics.
+ * @return SBASM_OK if the source code was assembled or the error type.
+ */
+int sbasm_assemble(const char *src, size_t len, const sbasm_options_t *options,
+                   sbasm_result_t *result)
+{
+    context_t *previous = context_current();
+    context_t *context = malloc(sizeof(context_t));
+    preprocessor_t *preprocessor = malloc(sizeof(preprocessor_t));
+    diagnostics_t *diagnostics = malloc(sizeof(diagnostics_t));
+    int max_errors = (options && (options->max_errors > 0)) ? options->max_errors : 1;
+    int scan_chunks = (options && (options->scan_chunks > 0)) ? options->scan_chunks : 0;
+    FILE *out = NULL;
+    int status;
+    int i;
+    
+    result->object = NULL;
+    result->object_size = 0;
+    result->diagnostics = NULL;
+    result->diagnostic_count = 0;
+    result->diagnostic_capacity = 0;
+    result->progress = NULL;
+    result->progress_size = 0;
+    
+    if (options && options->keep_progress)
+        out = open_memstream(&result->progress, &result->progress_size);
+    
+    if (diagnostics && !diagnostics_init(diagnostics, max_errors))
+    {
+        free(diagnostics);
+        diagnostics = NULL;
+    }
+    
+    if (!context || !preprocessor || !diagnostics ||
+        (options && options->keep_progress && !out))
+    {
+        if (out)
+            fclose(out);
+        
+        if (diagnostics)
+            diagnostics_destroy(diagnostics);
+        
+        free(diagnostics);
+        free(context);
+        free(preprocessor);
+        return SBASM_ERROR_FILE;
+    }
+    
+    context_init(context, out, stderr);
+    context->report = diagnostics_report;
+    context->report_arg = diagnostics;
+    context_enter(context);
+    
+    if (setjmp(context->jump) == 0)
+    {
+        preprocess_buffer(preprocessor, src, len, scan_chunks);
+        assemble_to_buffer(preprocessor, &result->object, &result->object_size);
+        preprocessor_destroy(preprocessor);
+    }
+    
+    context_cleanup(context);
+    
+    if (previous)
+        context_enter(previous);
+    else
+        context_leave();
+    
+    if (out)
+        fclose(out);
+    
+    diagnostics_sort(diagnostics);
+    
+    for (i = 0; i < diagnostics->count; ++i)
+        sbasm_add_diagnostic(result, &diagnostics->entries[i]);
+    
+    status = context->status;
+    diagnostics_destroy(diagnostics);
+    free(diagnostics);
+    free(preprocessor);
+    free(context);
+    
+    return status;
+}
+
+/**
+ * Add an error collected by the assembly to the diagnostics of the result. It is dropped
+ * if there is no memory left for it.
+ * @param result Pointer to a sbasm result struct.
+ * @param entry Error collected.
+ */
+void sbasm_add_diagnostic(sbasm_result_t *result, const diagnostic_t *entry)
+{
+    sbasm_diagnostic_t *diagnostics = result->diagnostics;
+    sbasm_diagnostic_t *diagnostic;
+    int capacity = result->diagnostic_capacity;
+    
+    if (result->diagnostic_count == capacity)
+    {
+        capacity = capacity ? capacity*2 : SBASM_INITIAL_DIAGNOSTICS;
+        diagnostics = realloc(diagnostics, sizeof(sbasm_diagnostic_t)*capacity);
+        
+        if (!diagnostics)
+            return;
+        
+        result->diagnostics = diagnostics;
+        result->diagnostic_capacity = capacity;
+    }
+    
+    diagnostic = &result->diagnostics[result->diagnostic_count];
+    diagnostic->type = entry->type;
+    diagnostic->line_number = entry->line_number;
+    diagnostic->message = malloc(strlen(entry->message) + 1);
+    
+    if (!diagnostic->message)
+        return;
+    
+    strcpy(diagnostic->message, entry->message);
+    ++result->diagnostic_count;
+}
+
+/**
+ * Free all memory held by the result of an assembly.
+ * @param result Pointer to a sbasm result struct.
+ */
+void sbasm_result_free(sbasm_result_t *result)
+{
+    int i;
+    
+    for (i = 0; i < result->diagnostic_count; ++i)
+        free(result->diagnostics[i].message);
+    
+    free(result->diagnostics);
+    free(result->object);
+    free(result->progress);
+    
+    result->object = NULL;
+    result->object_size = 0;
+    result->diagnostics = NULL;
+    result->diagnostic_count = 0;
+    result->diagnostic_capacity = 0;
+    result->progress = NULL;
+    result->progress_size = 0;
+}
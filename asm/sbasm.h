@@ -0,0 +1,109 @@
+/**
+ * @file   sbasm.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the assembler library interface
+ *
+ * The library assembles source code kept in memory into an object file kept in memory,
+ * so the assembler can be embedded in other programs and called many times in the same
+ * process. Errors never exit the program: the assembly stops, its memory is released and
+ * the error comes back as a diagnostic, along with the error type as the return value.
+ * The assembly may also keep going after errors, so they all come back sorted by line.
+ * Nothing is shared between calls, so any number of them may run at once on different
+ * threads.
+ *
+ * Example usage
+ *
+    sbasm_options_t options;
+    sbasm_result_t result;
+    int i;
+    
+    sbasm_options_init(&options);
+    
+    if (sbasm_assemble(source, strlen(source), &options, &result) == SBASM_OK)
+        fwrite(result.object, 1, result.object_size, fp);
+    
+    for (i = 0; i < result.diagnostic_count; ++i)
+        printf("line %d: %s\n", result.diagnostics[i].line_number,
+               result.diagnostics[i].message);
+    
+    sbasm_result_free(&result);
+ */
+
+#ifndef _SBASM_H_
+#define _SBASM_H_
+
+#include <stddef.h>
+
+/* Returned when the source code was assembled */
+#define SBASM_OK 0
+
+/* Error types, returned when the assembly failed and set in the diagnostics */
+#define SBASM_ERROR_COMMAND_LINE 1
+#define SBASM_ERROR_FILE 2
+#define SBASM_ERROR_OBJECT_FILE 3
+/* Reserved: never returned, as the error type it stood for is no longer used */
+#define SBASM_ERROR_LINKED_LIST 4
+#define SBASM_ERROR_SCANNER 5
+#define SBASM_ERROR_LEXICAL 6
+#define SBASM_ERROR_SYNTACTIC 7
+#define SBASM_ERROR_SEMANTIC 8
+#define SBASM_ERROR_THREAD 9
+
+/*
+ * A sbasm options struct contains the following fields:
+ * - keep_progress: Whether the progress the command line assembler prints is kept in the
+ *                  result.
+ * - max_errors: Number of errors after which the assembly stops, or 0 for stopping at the
+ *               first one.
+ * - scan_chunks: Number of chunks the source is scanned in, in parallel, or 0 for choosing
+ *                it from the size of the source. The result does not depend on it.
+ */
+typedef struct
+{
+    int keep_progress;
+    int max_errors;
+    int scan_chunks;
+} sbasm_options_t;
+
+/*
+ * A sbasm diagnostic struct contains the following fields:
+ * - type: Error type, as one of the SBASM_ERROR values.
+ * - line_number: Line number at which the error occurred, or 0 if there is none.
+ * - message: Error message.
+ */
+typedef struct
+{
+    int type;
+    int line_number;
+    char *message;
+} sbasm_diagnostic_t;
+
+/*
+ * A sbasm result struct contains the following fields:
+ * - object: Object file contents, or NULL if the assembly failed.
+ * - object_size: Number of bytes of the object file.
+ * - diagnostics: Errors of the assembly, sorted by line number.
+ * - diagnostic_count: Number of diagnostics.
+ * - diagnostic_capacity: Number of diagnostics allocated.
+ * - progress: Progress text, or NULL if it was not kept.
+ * - progress_size: Number of characters of the progress text.
+ */
+typedef struct
+{
+    unsigned char *object;
+    size_t object_size;
+    sbasm_diagnostic_t *diagnostics;
+    int diagnostic_count;
+    int diagnostic_capacity;
+    char *progress;
+    size_t progress_size;
+} sbasm_result_t;
+
+void sbasm_options_init(sbasm_options_t *options);
+int sbasm_assemble(const char *src, size_t len, const sbasm_options_t *options,
+                   sbasm_result_t *result);
+void sbasm_result_free(sbasm_result_t *result);
+
+#endif /* _SBASM_H_ */
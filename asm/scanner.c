@@ -6,85 +6,349 @@
  *
  * @brief  Implements scanner functions
  *
- * Scan elements of a line and provide utility functions, for example, to sanitize tokens
- * and check classes of characters and tokens (end of line, number etc).
+ * Scan elements of a line and provide utility functions, for example, to check classes of
+ * characters and tokens (end of line, number etc).
+ *
+ * Lexing is driven by tables: a character class table, and the transitions of a small
+ * automaton which recognizes identifiers, numbers and indexed operands.
  */
 
 #include "scanner.h"
 
+/* Shorthands for the character class table, only defined while declaring it */
+#define OT CHAR_OTHER
+#define SP CHAR_SEPARATOR
+#define CO CHAR_COLON
+#define CM CHAR_COMMENT
+#define SG CHAR_SIGN
+#define ZE CHAR_ZERO
+#define OC CHAR_OCTAL
+#define DE CHAR_DECIMAL
+#define HX CHAR_HEX_LETTER
+#define XX CHAR_X
+#define LE CHAR_LETTER
+#define US CHAR_UNDERSCORE
+#define OB CHAR_OPEN_BRACKET
+#define CB CHAR_CLOSE_BRACKET
+#define lh (CHAR_HEX_LETTER | CHAR_LOWERCASE)
+#define lx (CHAR_X | CHAR_LOWERCASE)
+#define ll (CHAR_LETTER | CHAR_LOWERCASE)
+
+/* Class of each character, indexed by its unsigned value */
+static const unsigned char char_classes[256] =
+{
+    /* 0x00 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, SP, OT, OT, OT, OT, OT, OT,
+    /* 0x10 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0x20 */ SP, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, SG, SP, SG, OT, OT,
+    /* 0x30 */ ZE, OC, OC, OC, OC, OC, OC, OC, DE, DE, CO, CM, OT, OT, OT, OT,
+    /* 0x40 */ OT, HX, HX, HX, HX, HX, HX, LE, LE, LE, LE, LE, LE, LE, LE, LE,
+    /* 0x50 */ LE, LE, LE, LE, LE, LE, LE, LE, XX, LE, LE, OB, OT, CB, OT, US,
+    /* 0x60 */ OT, lh, lh, lh, lh, lh, lh, ll, ll, ll, ll, ll, ll, ll, ll, ll,
+    /* 0x70 */ ll, ll, ll, ll, ll, ll, ll, ll, lx, ll, ll, OT, OT, OT, OT, OT,
+    /* 0x80 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0x90 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xA0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xB0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xC0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xD0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xE0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    /* 0xF0 */ OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT
+};
+
+#undef OT
+#undef SP
+#undef CO
+#undef CM
+#undef SG
+#undef ZE
+#undef OC
+#undef DE
+#undef HX
+#undef XX
+#undef LE
+#undef US
+#undef OB
+#undef CB
+#undef lh
+#undef lx
+#undef ll
+
+/* Next automaton state, indexed by the current state and the class of the character */
+static const unsigned char lexer_transitions[LEXER_STATE_COUNT][CHAR_CLASS_COUNT] =
+{
+    /* Other, separator, colon, comment, sign, 0, 1-7, 8-9, A-F, X, G-Z, _, [, ] */
+    { /* LEXER_START */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_SIGN, LEXER_ZERO, LEXER_DECIMAL, LEXER_DECIMAL,
+        LEXER_IDENTIFIER, LEXER_IDENTIFIER, LEXER_IDENTIFIER, LEXER_IDENTIFIER,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_IDENTIFIER */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_IDENTIFIER, LEXER_IDENTIFIER, LEXER_IDENTIFIER,
+        LEXER_IDENTIFIER, LEXER_IDENTIFIER, LEXER_IDENTIFIER, LEXER_IDENTIFIER,
+        LEXER_INDEX_START, LEXER_INVALID
+    },
+    { /* LEXER_SIGN */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_ZERO, LEXER_DECIMAL, LEXER_DECIMAL,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_ZERO */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_OCTAL, LEXER_OCTAL, LEXER_INVALID,
+        LEXER_INVALID, LEXER_HEX_PREFIX, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_HEX_PREFIX */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_HEX, LEXER_HEX, LEXER_HEX,
+        LEXER_HEX, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_OCTAL */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_OCTAL, LEXER_OCTAL, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_DECIMAL */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_DECIMAL, LEXER_DECIMAL, LEXER_DECIMAL,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_HEX */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_HEX, LEXER_HEX, LEXER_HEX,
+        LEXER_HEX, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_INDEX_START */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_ZERO, LEXER_INDEX_DECIMAL, LEXER_INDEX_DECIMAL,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_END
+    },
+    { /* LEXER_INDEX_ZERO */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_OCTAL, LEXER_INDEX_OCTAL, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_HEX_PREFIX, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_END
+    },
+    { /* LEXER_INDEX_HEX_PREFIX */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_HEX, LEXER_INDEX_HEX, LEXER_INDEX_HEX,
+        LEXER_INDEX_HEX, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_INDEX_OCTAL */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_OCTAL, LEXER_INDEX_OCTAL, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_END
+    },
+    { /* LEXER_INDEX_DECIMAL */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_DECIMAL, LEXER_INDEX_DECIMAL, LEXER_INDEX_DECIMAL,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_END
+    },
+    { /* LEXER_INDEX_HEX */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_HEX, LEXER_INDEX_HEX, LEXER_INDEX_HEX,
+        LEXER_INDEX_HEX, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INDEX_END
+    },
+    { /* LEXER_INDEX_END */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    },
+    { /* LEXER_INVALID */
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID, LEXER_INVALID, LEXER_INVALID,
+        LEXER_INVALID, LEXER_INVALID
+    }
+};
+
+/* Base of the digits accumulated when entering each state, or 0 for no digit */
+static const unsigned char lexer_bases[LEXER_STATE_COUNT] =
+{
+    0, 0, 0, 8, 0, 8, 10, 16, 0, 8, 0, 8, 10, 16, 0, 0
+};
+
+/* Kind of the token when it finishes in each state */
+static const unsigned char lexer_kinds[LEXER_STATE_COUNT] =
+{
+    TOKEN_NONE, TOKEN_IDENTIFIER, TOKEN_INVALID, TOKEN_NUMBER, TOKEN_INVALID, TOKEN_NUMBER,
+    TOKEN_NUMBER, TOKEN_NUMBER, TOKEN_UNCLOSED, TOKEN_UNCLOSED, TOKEN_UNCLOSED,
+    TOKEN_UNCLOSED, TOKEN_UNCLOSED, TOKEN_UNCLOSED, TOKEN_INDEXED, TOKEN_INVALID
+};
+
 /**
  * Separate line elements in: label, operation, and operands. This is done by using a
  * state machine, that identifies which element is being extracted at the current time.
  * 
- * First, it copies the line to copy_line because it is consumed by the token extraction
- * function.
+ * Tokens are delimited by separators and stored as spans pointing into the line. The line
+ * ends at its length or at the beginning of a comment. It is read only once, with
+ * lowercase letters folded to uppercase in place.
  * 
- * Start the state machine with PARSER_STATE_OPERATION, i.e., trying to extract the
- * operation token. However, if the extracted token is a LABEL, it changes to
- * PARSER_STATE_LABEL initially.
+ * Start the state machine with SCANNER_STATE_OPERATION, i.e., trying to extract the
+ * operation token. However, if the extracted token is a LABEL, recognized by its last
+ * character being ':', it changes to SCANNER_STATE_LABEL initially.
  * 
  * @param el element pointer.
- * @param line string pointer.
+ * @param line Line characters, not necessarily null-terminated.
+ * @param length Number of characters in the line.
+ * @return Number of characters in the line without its comment.
  */
-void scan_line_elements(element_t *el, char *line)
+int scan_line_elements(element_t *el, char *line, int length)
 {
-    char *token;
+    char *p = line;
+    char *end = line + length;
+    int char_class;
+    int is_label;
+    span_t token;
     scanner_state_t state = SCANNER_STATE_OPERATION;
-    int line_size = strlen(line);
-    char copy_line[line_size];
-    
-    strcpy(copy_line, line);
     
-    token = strtok(copy_line, " ,\t");
-    while (token != NULL)
+    while (p < end)
     {
-        if (is_label(token))
-            state = SCANNER_STATE_LABEL;
+        char_class = char_classes[(unsigned char)*p];
         
-        sanitize_token_ending(token);
+        if (char_class == CHAR_COMMENT)
+            break;
+        
+        if (char_class == CHAR_SEPARATOR)
+        {
+            ++p;
+            continue;
+        }
+        
+        p = scan_token(&token, p, end, &is_label);
+        
+        if (is_label)
+            state = SCANNER_STATE_LABEL;
         
         switch (state)
         {
             case SCANNER_STATE_LABEL:
-                strcpy(el->label, token);
+                el->label = token;
                 break;
             case SCANNER_STATE_OPERATION:
-                strcpy(el->operation, token);
+                el->operation = token;
                 break;
             case SCANNER_STATE_OPERAND_1:
-                strcpy(el->operand1, token);
+                el->operand1 = token;
                 break;
             case SCANNER_STATE_OPERAND_2:
-                strcpy(el->operand2, token);
+                el->operand2 = token;
                 break;
             default:
                 break;
         }
         ++state;
-        token = strtok(NULL, " ,\t");
     }
+    
+    return p - line;
 }
 
 /**
- * Remove undesirable chars from the token, such as '\n', ':' etc, by changing the end of
- * the string with '\0'.
- * @param token string pointer.
+ * Scan one token, running the token automaton over its characters. The token goes until
+ * the next separator or comment, but its contents end at its first ':'. The value of
+ * numbers and offsets is accumulated digit by digit, saturating at LONG_MIN and LONG_MAX
+ * as strtol does.
+ * @param token Stores the token span.
+ * @param start First character of the token, which must not be a separator.
+ * @param end End of the line.
+ * @param is_label Set to 1 if the token ends with ':' or 0 otherwise.
+ * @return Pointer to the character following the token.
  */
-void sanitize_token_ending(char *token)
+char* scan_token(span_t *token, char *start, char *end, int *is_label)
 {
-    int i;
+    char *p;
+    char *contents_end = NULL;
+    int char_class;
+    int base;
+    int digit;
+    int is_negative = 0;
+    int name_length = 0;
+    unsigned long value = 0;
+    unsigned long limit = LONG_MAX;
+    lexer_state_t state = LEXER_START;
     
-    for(i = 0; token[i] != '\0'; i++)
+    for (p = start; p < end; ++p)
     {
-        switch (token[i])
+        char_class = char_classes[(unsigned char)*p];
+        
+        if (char_class & CHAR_LOWERCASE)
         {
-            case '\n':
-            case ':':
-            case -1: /* This one is weird and appears on the last word of the file */
-                token[i] = '\0';
-                break;
+            *p -= 'a' - 'A';
+            char_class &= CHAR_CLASS_MASK;
+        }
+        
+        if ((char_class == CHAR_SEPARATOR) || (char_class == CHAR_COMMENT))
+            break;
+        
+        /* Characters after ':' are only folded */
+        if (contents_end)
+            continue;
+        
+        if (char_class == CHAR_COLON)
+        {
+            contents_end = p;
+            continue;
+        }
+        
+        if (state == LEXER_START)
+        {
+            is_negative = (*p == '-');
+            if (is_negative)
+                limit = (unsigned long)LONG_MAX + 1;
+        }
+        
+        state = lexer_transitions[state][char_class];
+        base = lexer_bases[state];
+        
+        if (state == LEXER_INDEX_START)
+        {
+            name_length = p - start;
+        }
+        else if (base)
+        {
+            digit = (char_class == CHAR_HEX_LETTER) ? (*p - 'A' + 10) : (*p - '0');
+            
+            if (value > (limit - digit)/base)
+                value = limit;
+            else
+                value = value*base + digit;
         }
     }
+    
+    if (contents_end == NULL)
+        contents_end = p;
+    
+    *is_label = (*(p - 1) == ':');
+    
+    token->ptr = start;
+    token->length = contents_end - start;
+    token->kind = lexer_kinds[state];
+    token->name_length = token->length;
+    
+    if ((token->kind == TOKEN_INDEXED) || (token->kind == TOKEN_UNCLOSED))
+        token->name_length = name_length;
+    
+    if (!is_negative)
+        token->value = value;
+    else if (value > LONG_MAX)
+        token->value = LONG_MIN;
+    else
+        token->value = -(long)value;
+    
+    return p;
 }
 
 /**
@@ -94,13 +358,7 @@ void sanitize_token_ending(char *token)
  */
 int is_separator(char c)
 {
-    switch (c)
-    {
-        case ' ':
-            return 1;
-    }
-    
-    return 0;
+    return (char_classes[(unsigned char)c] == CHAR_SEPARATOR);
 }
 
 /**
@@ -120,110 +378,36 @@ int is_end_of_line(char c)
     return 0;
 }
 
-/**
- * Check whether a given token is a label, which is recognized by its last character being
- * ":".
- * @param token string pointer.
- * @return 1 if token is a label or 0 otherwise.
- */
-int is_label(char *token)
-{
-    int token_size = strlen(token);
-    char last_char = token[token_size - 1]; /* Ignoring \0 */
-    return (last_char == ':');
-}
-
 /**
  * Check whether a given token is has a valid label naming, which must be composed by
  * characters 0-9, a-z, A-Z and _ (underscore).
  * Label names cannot start with a number.
- * @param token string pointer.
+ * @param token span pointer.
  * @return 1 if token is a label or 0 otherwise.
  */
-int is_valid_label(char *token)
+int is_valid_label(const span_t *token)
 {
-    char c;
-    int i;
-    int token_size;
-    
-    /* Exit immediately if starts with a number */
-    if (token[0] >= '0' && token[0] <= '9')
-        return 0;
-    
-    token_size = strlen(token) - 1; /* Ignoring the ':' character of a label */
-    
-    for (i = 0; i < token_size; ++i)
-    {
-        c = token[i];
-        if (!((c >= '0' && c <= '9') ||
-              (c >= 'a' && c <= 'z') ||
-              (c >= 'A' && c <= 'Z') ||
-              (c == '_')))
-              return 0;
-    }
-    
-    return 1;
+    return (token->kind == TOKEN_IDENTIFIER);
 }
 
 /**
- * Check whether a given token is has a valid operand naming, which must be composed by
- * characters 0-9, a-z, A-Z, _ (underscore), and [ ] (square brackets for array access).
- * Label names cannot start with a number.
- * Similar implementation as is_valid_label.
- * @param token string pointer.
+ * Check whether a given token is has a valid operand naming, which must be a label name,
+ * optionally followed by an offset in square brackets for array access, as in LABEL[N].
+ * @param token span pointer.
  * @return 1 if token is a label or 0 otherwise.
  */
-int is_valid_operand(char *token)
+int is_valid_operand(const span_t *token)
 {
-    char c;
-    int i;
-    int token_size;
-    
-    /* Exit immediately if starts with a number */
-    if (token[0] >= '0' && token[0] <= '9')
-        return 0;
-    
-    token_size = strlen(token) - 1; /* Ignoring the ':' character of a label */
-    
-    for (i = 0; i < token_size; ++i)
-    {
-        c = token[i];
-        if (!((c >= '0' && c <= '9') ||
-              (c >= 'a' && c <= 'z') ||
-              (c >= 'A' && c <= 'Z') ||
-              (c == '_') ||
-              (c == '[') ||
-              (c == ']')))
-              return 0;
-    }
-    
-    return 1;
+    return ((token->kind == TOKEN_IDENTIFIER) || (token->kind == TOKEN_INDEXED));
 }
 
 /**
- * Check whether a given token is a valid representation of a number.
- *
- * Uses the strtol function, from stdlib, which converts a string to long int. This
- * function returns the converted number and sets its second parameter, a char** pointer,
- * to the address of the last character which is evaluated during conversion. If this
- * address is not at the end of the token, it means that the conversion was not successful
- * because the token is not a valid representation of a number.
- * The last parameter is the base of the number, which may be 2, 8, 10, 16, etc. If it is
- * set to 0, it will try and get the representation from the token format.
- * More info avaliable at: http://www.cplusplus.com/reference/cstdlib/strtol/
- *
- * @param token string pointer.
+ * Check whether a given token is a valid representation of a number, in decimal, octal or
+ * hexadecimal notation.
+ * @param token span pointer.
  * @return 1 if token is a number or 0 otherwise.
  */
-int is_number(char *token)
+int is_number(const span_t *token)
 {
-    char *end_ptr;
-    int diff;
-    int length;
-    
-    strtol(token, &end_ptr, 0);
-    diff = end_ptr - token;
-    length = strlen(token);
-    
-    return (diff == length);
-}
\ No newline at end of file
+    return (token->kind == TOKEN_NUMBER);
+}
@@ -8,6 +8,10 @@
  *
  * The scanner is responsible of getting a assembly line and separate all of its elements
  * into tokens with respect to the language syntax.
+ *
+ * Tokens are spans over the line, so scanning copies nothing and keeps no state between
+ * calls. Each character is read once: a character class table drives a small automaton
+ * which classifies the token, parses its value and folds it to uppercase as it goes.
  */
 
 #ifndef _SCANNER_H_
@@ -16,12 +20,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <limits.h>
 #include "elements.h"
 #include "error.h"
 
-#define TOKEN_BUFFER_SIZE 100
-
 typedef enum
 {
     SCANNER_STATE_LABEL,
@@ -30,13 +32,64 @@ typedef enum
     SCANNER_STATE_OPERAND_2
 } scanner_state_t;
 
-void scan_line_elements(element_t *el, char *line);
-void sanitize_token_ending(char *token);
+/**
+ * Classes of characters, as found in the character class table. Digits are split by the
+ * bases they belong to, and letters by whether they are hexadecimal digits.
+ */
+typedef enum
+{
+    CHAR_OTHER,
+    CHAR_SEPARATOR,
+    CHAR_COLON,
+    CHAR_COMMENT,
+    CHAR_SIGN,
+    CHAR_ZERO,
+    CHAR_OCTAL,
+    CHAR_DECIMAL,
+    CHAR_HEX_LETTER,
+    CHAR_X,
+    CHAR_LETTER,
+    CHAR_UNDERSCORE,
+    CHAR_OPEN_BRACKET,
+    CHAR_CLOSE_BRACKET,
+    CHAR_CLASS_COUNT
+} char_class_t;
+
+/* Flag set in the character class table for lowercase letters, which are folded */
+#define CHAR_LOWERCASE 0x80
+#define CHAR_CLASS_MASK 0x7F
+
+/**
+ * States of the token automaton. Numbers and offsets have one state per base, which
+ * tells how to accumulate the next digit.
+ */
+typedef enum
+{
+    LEXER_START,
+    LEXER_IDENTIFIER,
+    LEXER_SIGN,
+    LEXER_ZERO,
+    LEXER_HEX_PREFIX,
+    LEXER_OCTAL,
+    LEXER_DECIMAL,
+    LEXER_HEX,
+    LEXER_INDEX_START,
+    LEXER_INDEX_ZERO,
+    LEXER_INDEX_HEX_PREFIX,
+    LEXER_INDEX_OCTAL,
+    LEXER_INDEX_DECIMAL,
+    LEXER_INDEX_HEX,
+    LEXER_INDEX_END,
+    LEXER_INVALID,
+    LEXER_STATE_COUNT
+} lexer_state_t;
+
+int scan_line_elements(element_t *el, char *line, int length);
+char* scan_token(span_t *token, char *start, char *end, int *is_label);
 int is_separator(char c);
 int is_end_of_line(char c);
-int is_label(char *token);
-int is_valid_label(char *token);
-int is_valid_operand(char *token);
-int is_number(char *token);
+int is_valid_label(const span_t *token);
+int is_valid_operand(const span_t *token);
+int is_number(const span_t *token);
 
 #endif /* _SCANNER_H_ */
\ No newline at end of file
@@ -0,0 +1,176 @@
+/**
+ * @file   source.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the source buffer
+ *
+ * The file is read with as few calls as possible: regular files are read in a single
+ * call, since their size is known, while other files are read into a buffer that grows
+ * geometrically. Line boundaries are found with memchr, which the C library implements
+ * with vector instructions, instead of checking one character at a time.
+ */
+
+#include "source.h"
+
+/**
+ * Read a whole file into a source buffer.
+ * @param source Pointer to a source struct.
+ * @param filename Name of the file to be read.
+ */
+void source_open(source_t *source, char *filename)
+{
+    FILE *fp = file_open(filename, "rb");
+    struct stat file_stat;
+    size_t capacity = SOURCE_INITIAL_CAPACITY;
+    size_t read_size;
+    
+    /* One more byte, so reaching the end of file does not grow the buffer */
+    if ((fstat(fileno(fp), &file_stat) == 0) && (S_ISREG(file_stat.st_mode)))
+        capacity = file_stat.st_size + 1;
+    
+    source->data = malloc(capacity);
+    source->original = NULL;
+    source->size = 0;
+    
+    if (!source->data)
+        error(ERROR_FILE, "Cannot allocate memory for file %s", filename);
+    
+    while ((read_size = fread(source->data + source->size, 1, capacity - source->size,
+                              fp)) > 0)
+    {
+        source->size += read_size;
+        
+        if (source->size == capacity)
+        {
+            capacity *= 2;
+            source->data = realloc(source->data, capacity);
+            
+            if (!source->data)
+                error(ERROR_FILE, "Cannot allocate memory for file %s", filename);
+        }
+    }
+    
+    if (ferror(fp))
+        error(ERROR_FILE, "Cannot read file %s", filename);
+    
+    file_close(fp);
+    
+    source->data[source->size] = '\0';
+    source_rewind(source);
+}
+
+/**
+ * Copy source code kept in memory into a source buffer. The copy is writable, as the
+ * scanner changes the case of the source in place.
+ * @param source Pointer to a source struct.
+ * @param data Source code, which does not need to be null-terminated.
+ * @param size Number of characters of the source code.
+ */
+void source_open_buffer(source_t *source, const char *data, size_t size)
+{
+    source->data = malloc(size + 1);
+    source->original = NULL;
+    source->size = size;
+    
+    if (!source->data)
+        error(ERROR_FILE, "Cannot allocate memory for source code");
+    
+    memcpy(source->data, data, size);
+    source->data[size] = '\0';
+    source_rewind(source);
+}
+
+/**
+ * Free the memory allocated for a source buffer.
+ * @param source Pointer to a source struct.
+ */
+void source_close(source_t *source)
+{
+    free(source->data);
+    free(source->original);
+    source->data = NULL;
+    source->original = NULL;
+    source->size = 0;
+}
+
+/**
+ * Keep a copy of the source buffer as it is now, so its lines can be shown as written
+ * after the scanner changed them in place.
+ * @param source Pointer to a source struct, already read.
+ */
+void source_keep_original(source_t *source)
+{
+    source->original = malloc(source->size + 1);
+    
+    if (!source->original)
+        error(ERROR_FILE, "Cannot allocate memory for source code");
+    
+    memcpy(source->original, source->data, source->size + 1);
+}
+
+/**
+ * Get a line of the source buffer as it was read, with its comment. The line is left as
+ * it is if no copy of the source buffer was kept.
+ * @param source Pointer to a source struct.
+ * @param line Line view of the source buffer, which may have been cut short.
+ * @param original Stores the line view of the copy, up to the end of the line.
+ */
+void source_original_line(const source_t *source, const source_line_t *line,
+                          source_line_t *original)
+{
+    char *start;
+    char *end;
+    char *newline;
+    
+    *original = *line;
+    
+    if (!source->original)
+        return;
+    
+    start = source->original + (line->ptr - source->data);
+    end = source->original + source->size;
+    newline = memchr(start, '\n', end - start);
+    
+    original->ptr = start;
+    original->length = (newline ? newline : end) - start;
+}
+
+/**
+ * Go back to the first line of the source buffer.
+ * @param source Pointer to a source struct.
+ */
+void source_rewind(source_t *source)
+{
+    source->position = 0;
+    source->line_number = 0;
+}
+
+/**
+ * Get the next line of the source buffer. The last line does not need to end with '\n'.
+ * @param source Pointer to a source struct.
+ * @param line Stores the line view.
+ * @return 1 if a line was read or 0 at the end of the buffer.
+ */
+int source_next_line(source_t *source, source_line_t *line)
+{
+    char *start = source->data + source->position;
+    char *end = source->data + source->size;
+    char *newline;
+    
+    if (source->position >= source->size)
+        return 0;
+    
+    newline = memchr(start, '\n', end - start);
+    
+    if (!newline)
+        newline = end;
+    
+    line->ptr = start;
+    line->length = newline - start;
+    line->number = ++source->line_number;
+    
+    source->position = (newline - source->data) + 1;
+    
+    return 1;
+}
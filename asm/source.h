@@ -0,0 +1,75 @@
+/**
+ * @file   source.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the source buffer
+ *
+ * The source buffer reads a whole file into memory at once and hands out its lines as
+ * views, with their line numbers. Lines may have any length and are never copied.
+ *
+ * Example usage
+ *
+    source_t source;
+    source_line_t line;
+    
+    source_open(&source, "program.asm");
+    
+    while (source_next_line(&source, &line))
+        printf("%d: %.*s\n", line.number, line.length, line.ptr);
+    
+    source_close(&source);
+ */
+
+#ifndef _SOURCE_H_
+#define _SOURCE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "file.h"
+
+/* Buffer size used when the file size is not known in advance, as for pipes */
+#define SOURCE_INITIAL_CAPACITY 4096
+
+/*
+ * A source struct contains the following fields:
+ * - data: File contents, followed by a '\0'.
+ * - original: Copy of the file contents as read, before the scanner changes them in place,
+ *             or NULL if it is not kept.
+ * - size: Number of bytes in the file.
+ * - position: Offset of the next line in data.
+ * - line_number: Number of the last line handed out.
+ */
+typedef struct
+{
+    char *data;
+    char *original;
+    size_t size;
+    size_t position;
+    int line_number;
+} source_t;
+
+/**
+ * A line of the source buffer, without its '\n'. The source buffer owns the characters,
+ * which may be changed in place but are not null-terminated.
+ */
+typedef struct
+{
+    char *ptr;
+    int length;
+    int number;
+} source_line_t;
+
+void source_open(source_t *source, char *filename);
+void source_open_buffer(source_t *source, const char *data, size_t size);
+void source_close(source_t *source);
+void source_keep_original(source_t *source);
+void source_original_line(const source_t *source, const source_line_t *line,
+                          source_line_t *original);
+void source_rewind(source_t *source);
+int source_next_line(source_t *source, source_line_t *line);
+
+#endif /* _SOURCE_H_ */
@@ -0,0 +1,63 @@
+/**
+ * @file   span.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements token span routines
+ *
+ * Spans replace the null-terminated strings of the string library, so each routine here
+ * takes the length of the span into account instead of looking for a '\0'.
+ */
+
+#include "span.h"
+
+/**
+ * Init a span as empty. Its pointer is set to an empty string, so it is always safe to
+ * print it.
+ * @param span span pointer.
+ */
+void span_init(span_t *span)
+{
+    span->ptr = "";
+    span->length = 0;
+    span->kind = TOKEN_NONE;
+    span->value = 0;
+    span->name_length = 0;
+}
+
+/**
+ * Set the characters and kind of a span, with no value.
+ * @param span span pointer.
+ * @param ptr First character of the token.
+ * @param length Number of characters in the token.
+ * @param kind Kind of the token.
+ */
+void span_set(span_t *span, const char *ptr, int length, token_kind_t kind)
+{
+    span->ptr = ptr;
+    span->length = length;
+    span->kind = kind;
+    span->value = 0;
+    span->name_length = length;
+}
+
+/**
+ * Check whether a span has no characters.
+ * @param span span pointer.
+ * @return 1 if span is empty or 0 otherwise.
+ */
+int span_is_empty(const span_t *span)
+{
+    return (span->length == 0);
+}
+
+/**
+ * Compare a span with a null-terminated string.
+ * @param span span pointer.
+ * @param str String to be compared.
+ * @return 1 if both have the same characters or 0 otherwise.
+ */
+int span_equals(const span_t *span, const char *str)
+{
+    return ((strncmp(span->ptr, str, span->length) == 0) && (str[span->length] == '\0'));
+}
@@ -0,0 +1,65 @@
+/**
+ * @file   span.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares token spans
+ *
+ * A span is a view of a token inside the line it was scanned from: a pointer to its first
+ * character, its length and its kind, along with the values the scanner parsed from it.
+ * Nothing is copied, so a span is only valid while the line buffer is unchanged, and it is
+ * not null-terminated. Print it with "%.*s".
+ */
+
+#ifndef _SPAN_H_
+#define _SPAN_H_
+
+#include <string.h>
+
+/**
+ * Kinds of tokens recognized by the scanner.
+ * - TOKEN_NONE: Empty token.
+ * - TOKEN_IDENTIFIER: Characters 0-9, a-z, A-Z and _ (underscore), not starting with a
+ *                     number.
+ * - TOKEN_NUMBER: Integer, in decimal, octal (leading 0) or hexadecimal (leading 0x)
+ *                 notation, with an optional sign.
+ * - TOKEN_INDEXED: Identifier followed by an offset, as in LABEL[N]. The offset is a
+ *                  decimal, octal or hexadecimal integer, and may be left empty.
+ * - TOKEN_UNCLOSED: Indexed operand missing the closing ']', as in LABEL[N.
+ * - TOKEN_INVALID: Anything else.
+ */
+typedef enum
+{
+    TOKEN_NONE,
+    TOKEN_IDENTIFIER,
+    TOKEN_NUMBER,
+    TOKEN_INDEXED,
+    TOKEN_UNCLOSED,
+    TOKEN_INVALID
+} token_kind_t;
+
+/*
+ * A span struct contains the following fields:
+ * - ptr: First character of the token.
+ * - length: Number of characters in the token.
+ * - kind: Kind of the token.
+ * - value: Value of a number or offset of an indexed operand. As with strtol, tokens which
+ *          are not numbers take the value of their longest leading number, or zero.
+ * - name_length: Number of characters before the offset of an indexed operand, or the
+ *                whole length for other tokens.
+ */
+typedef struct
+{
+    const char *ptr;
+    int length;
+    token_kind_t kind;
+    long value;
+    int name_length;
+} span_t;
+
+void span_init(span_t *span);
+void span_set(span_t *span, const char *ptr, int length, token_kind_t kind);
+int span_is_empty(const span_t *span);
+int span_equals(const span_t *span, const char *str);
+
+#endif /* _SPAN_H_ */
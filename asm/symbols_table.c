@@ -4,7 +4,7 @@
  * @author Lucas de Levy Oliveira
  * @date   10/04/2014
  *
- * @brief  Implements the initialization of the symbols tables
+ * @brief  Implements the symbols table
  */
 
 #include "symbols_table.h"
@@ -13,77 +13,228 @@
  * Init a symbols table
  * @param symbols_table a table pointer to store all the labels.
  */
-void symbols_table_init(hash_table_t *symbols_table)
+void symbols_table_init(symbols_table_t *symbols_table)
 {
-    hash_create(symbols_table, "Symbols");
+    symbols_table->capacity = SYMBOLS_TABLE_INITIAL_CAPACITY;
+    symbols_table->symbols = calloc(symbols_table->capacity, sizeof(symbol_t));
+    symbols_table->first_undefined = SYMBOLS_TABLE_NO_SYMBOL;
+    symbols_table->last_undefined = SYMBOLS_TABLE_NO_SYMBOL;
+    symbols_table->undefined_count = 0;
+    symbols_table->fixups = NULL;
+    symbols_table->fixup_count = 0;
+    symbols_table->fixup_capacity = 0;
 }
 
 /**
- * Add a new label to the symbols table.
- * @param symbols_table a table pointer to an already initialised hash table.
- * @param label instruction label string.
+ * Free the symbols of a symbols table.
+ * @param symbols_table a table pointer to an already initialised table.
+ */
+void symbols_table_destroy(symbols_table_t *symbols_table)
+{
+    free(symbols_table->symbols);
+    free(symbols_table->fixups);
+    symbols_table->symbols = NULL;
+    symbols_table->capacity = 0;
+    symbols_table->first_undefined = SYMBOLS_TABLE_NO_SYMBOL;
+    symbols_table->last_undefined = SYMBOLS_TABLE_NO_SYMBOL;
+    symbols_table->undefined_count = 0;
+    symbols_table->fixups = NULL;
+    symbols_table->fixup_count = 0;
+    symbols_table->fixup_capacity = 0;
+}
+
+/**
+ * Add a new label to the symbols table, growing the table when the id does not fit. It is
+ * undefined until symbols_table_define is called for it.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param id interned label id.
  * @param value position in the memory.
  * @param line_number source code line at which the label was called or defined.
  */
-void symbols_table_add(hash_table_t *symbols_table, char *label, int value, int line_number)
+void symbols_table_add(symbols_table_t *symbols_table, int id, int value, int line_number)
 {
-    symbol_t *symbol = malloc(sizeof(symbol_t));
+    symbol_t *symbol;
+    int capacity = symbols_table->capacity;
+    
+    if (id >= capacity)
+    {
+        while (id >= capacity)
+            capacity *= 2;
+        
+        symbols_table->symbols = realloc(symbols_table->symbols,
+                                         sizeof(symbol_t)*capacity);
+        memset(&symbols_table->symbols[symbols_table->capacity], 0,
+               sizeof(symbol_t)*(capacity - symbols_table->capacity));
+        symbols_table->capacity = capacity;
+    }
     
+    symbol = &symbols_table->symbols[id];
+    symbol->used = 1;
     symbol->value = value;
     symbol->defined = 0;
+    symbol->constant = 0;
     symbol->line_number = line_number;
-    hash_insert(symbols_table, label, symbol);
+    symbol->fixups = 0;
+    symbol->fixup_count = 0;
+    
+    /* Append to the list of undefined symbols */
+    symbol->previous_undefined = symbols_table->last_undefined;
+    symbol->next_undefined = SYMBOLS_TABLE_NO_SYMBOL;
+    
+    if (symbols_table->last_undefined != SYMBOLS_TABLE_NO_SYMBOL)
+        symbols_table->symbols[symbols_table->last_undefined].next_undefined = id;
+    else
+        symbols_table->first_undefined = id;
+    
+    symbols_table->last_undefined = id;
+    ++symbols_table->undefined_count;
 }
 
 /**
- * Black magic for checking whether any symbol was not defined yet.
- *
- * The implementation is not trivial but the idea is simple: access each hash table
- * position, access each linked list node and check whether the defined flag is set.
- * If any node has not been defined, return immediately its hash list node, which contains
- * all the necessary info (label and line number). Otherwise, keep looking until no node
- * is left and return NULL in the end.
- *
- * The following diagram shows the relationship between the pointers, since they are
- * strongly coupled.
- *
- * list_node_t [ *data | *next ]
- *                ||
- *                \/   / This is the hash list node pointer to be returned
- *         hash_list_node_t [ key | *data ]
- *                                    ||
- *                                    \/                / This is the defined flag to be checked
- *                                symbol_t [ value | defined | line_number ]
- *
- * @param symbols_table a table pointer to an already initialised hash table.
- * @return the label that is undefined or NULL.
+ * Look for the symbol of a label.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param id interned label id.
+ * @return pointer to the symbol or NULL if the label was never added.
+ */
+symbol_t* symbols_table_search(symbols_table_t *symbols_table, int id)
+{
+    if ((id < 0) || (id >= symbols_table->capacity) || !symbols_table->symbols[id].used)
+        return NULL;
+    
+    return &symbols_table->symbols[id];
+}
+
+/**
+ * Define the label of a symbol, removing it from the list of undefined symbols.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param id interned id of an undefined label, which must be in the table.
+ * @param value position in the memory.
+ */
+void symbols_table_define(symbols_table_t *symbols_table, int id, int value)
+{
+    symbol_t *symbol = &symbols_table->symbols[id];
+    
+    symbol->defined = 1;
+    symbol->value = value;
+    
+    if (symbol->previous_undefined != SYMBOLS_TABLE_NO_SYMBOL)
+        symbols_table->symbols[symbol->previous_undefined].next_undefined =
+            symbol->next_undefined;
+    else
+        symbols_table->first_undefined = symbol->next_undefined;
+    
+    if (symbol->next_undefined != SYMBOLS_TABLE_NO_SYMBOL)
+        symbols_table->symbols[symbol->next_undefined].previous_undefined =
+            symbol->previous_undefined;
+    else
+        symbols_table->last_undefined = symbol->previous_undefined;
+    
+    --symbols_table->undefined_count;
+}
+
+/**
+ * Check whether any symbol was not defined yet.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @return the id of the first label added that is undefined or SYMBOLS_TABLE_NO_SYMBOL.
  */
-hash_list_node_t* symbols_table_has_undefined(hash_table_t *symbols_table)
+int symbols_table_has_undefined(symbols_table_t *symbols_table)
 {
+    return symbols_table->first_undefined;
+}
+
+/**
+ * Get the next undefined symbol, in the order they were added.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param id interned id of an undefined label.
+ * @return the id of the next label that is undefined or SYMBOLS_TABLE_NO_SYMBOL.
+ */
+int symbols_table_next_undefined(symbols_table_t *symbols_table, int id)
+{
+    return symbols_table->symbols[id].next_undefined;
+}
+
+/**
+ * Record a reference to a label not defined yet.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param id interned id of the referenced label, which must be in the table.
+ * @param position position in the memory of the word referencing the label.
+ * @param offset offset to be added to the label value.
+ * @param opcode opcode of the instruction referencing the label.
+ * @param line_number source code line of the instruction referencing the label.
+ * @param is_write whether the instruction writes to the memory address of the label.
+ */
+void symbols_table_add_fixup(symbols_table_t *symbols_table, int id, int position,
+                             int offset, int opcode, int line_number, int is_write)
+{
+    fixup_t *fixup;
+    
+    if (symbols_table->fixup_count == symbols_table->fixup_capacity)
+    {
+        symbols_table->fixup_capacity = (symbols_table->fixup_capacity > 0)
+                                        ? 2*symbols_table->fixup_capacity
+                                        : SYMBOLS_TABLE_INITIAL_CAPACITY;
+        symbols_table->fixups = realloc(symbols_table->fixups, sizeof(fixup_t)*
+                                        symbols_table->fixup_capacity);
+    }
+    
+    fixup = &symbols_table->fixups[symbols_table->fixup_count++];
+    fixup->symbol = id;
+    fixup->position = position;
+    fixup->offset = offset;
+    fixup->opcode = opcode;
+    fixup->line_number = line_number;
+    fixup->is_write = is_write;
+    ++symbols_table->symbols[id].fixup_count;
+}
+
+/**
+ * Group the fixups by symbol, with a counting sort over the symbol ids, so the fixups of
+ * each symbol are contiguous from its fixups index. The sort is stable, so the fixups of
+ * a symbol stay in the order they were found. No fixup can be added afterwards.
+ * @param symbols_table a table pointer to an already initialised table.
+ */
+void symbols_table_group_fixups(symbols_table_t *symbols_table)
+{
+    symbol_t *symbols = symbols_table->symbols;
+    fixup_t *grouped;
+    fixup_t *fixup;
+    int start = 0;
+    int id;
     int i;
-    list_t *list_ptr;
-    list_node_t *current_node_ptr;
     
-    /* Check each hash table position */
-    for (i = 0; i < HASH_TABLE_SIZE; ++i)
+    if (symbols_table->fixup_count == 0)
+        return;
+    
+    grouped = malloc(sizeof(fixup_t)*symbols_table->fixup_count);
+    
+    for (id = 0; id < symbols_table->capacity; ++id)
     {
-        /* Get linked list pointer for the current table position */
-        list_ptr = &symbols_table->table[i];
-        
-        /* Start at the head of the list */
-        current_node_ptr = list_ptr->head;
-        
-        /* Run throughout the list */
-        while (current_node_ptr != NULL)
-        {
-            /* Black magic */
-            if (!((symbol_t*)((hash_list_node_t*)current_node_ptr->data)->data)->defined)
-                return ((hash_list_node_t*)current_node_ptr->data);
-            
-            /* Keep looking */
-            current_node_ptr = current_node_ptr->next;
-        }
+        symbols[id].fixups = start;
+        start += symbols[id].fixup_count;
+    }
+    
+    /* Each symbol fixups index is moved past its group while scattering */
+    for (i = 0; i < symbols_table->fixup_count; ++i)
+    {
+        fixup = &symbols_table->fixups[i];
+        grouped[symbols[fixup->symbol].fixups++] = *fixup;
     }
     
-    return NULL;
-}
\ No newline at end of file
+    for (id = 0; id < symbols_table->capacity; ++id)
+        symbols[id].fixups -= symbols[id].fixup_count;
+    
+    free(symbols_table->fixups);
+    symbols_table->fixups = grouped;
+    symbols_table->fixup_capacity = symbols_table->fixup_count;
+}
+
+/**
+ * Get a fixup by its index.
+ * @param symbols_table a table pointer to an already initialised table.
+ * @param index fixup index.
+ * @return pointer to the fixup, valid until another fixup is added.
+ */
+fixup_t* symbols_table_fixup(symbols_table_t *symbols_table, int index)
+{
+    return &symbols_table->fixups[index];
+}
@@ -5,23 +5,86 @@
  * @date   10/04/2014
  *
  * @brief  Declares the symbols table
+ *
+ * Symbols are indexed by the id the interner gives to their label, so searching a symbol
+ * is a single array access.
  */
 
 #ifndef _SYMBOLS_TABLE_H_
 #define _SYMBOLS_TABLE_H_
 
-#include "hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include "interner.h"
+
+#define SYMBOLS_TABLE_INITIAL_CAPACITY 64
+#define SYMBOLS_TABLE_NO_SYMBOL -1
 
+/*
+ * A fixup is a reference to a label not defined yet: the word at the given position must
+ * receive the label value plus the offset. The opcode, line number and whether the
+ * referencing instruction writes to the label are kept for checking the reference once
+ * every label is defined. Fixups are appended to a
+ * flat array in the order they are found and grouped by symbol once the source code is
+ * over, so all references to a label can be resolved together.
+ */
 typedef struct
 {
+    int symbol;
+    int position;
+    int offset;
+    int opcode;
+    int line_number;
+    int is_write;
+} fixup_t;
+
+/*
+ * A symbol is used when its label was either called or defined. The constant flag is set
+ * when the label is attached to a CONST directive. Fixup_count is the number of
+ * references made to the label before it was defined and, once fixups are grouped,
+ * fixups is the index of the first one. Undefined symbols are linked, in the order they
+ * were added, by the ids of the previous and next undefined symbols.
+ */
+typedef struct
+{
+    int used;
     int value;
     int defined;
+    int constant;
     int offset;
     int line_number;
+    int fixups;
+    int fixup_count;
+    int previous_undefined;
+    int next_undefined;
 } symbol_t;
 
-void symbols_table_init(hash_table_t *symbols_table);
-void symbols_table_add(hash_table_t *symbols_table, char *label, int value, int line_number);
-hash_list_node_t* symbols_table_has_undefined(hash_table_t *symbols_table);
+/*
+ * A symbols table struct contains the symbols, the fixups and the list of undefined
+ * symbols, from first_undefined to last_undefined, with undefined_count symbols in it.
+ */
+typedef struct
+{
+    symbol_t *symbols;
+    int capacity;
+    int first_undefined;
+    int last_undefined;
+    int undefined_count;
+    fixup_t *fixups;
+    int fixup_count;
+    int fixup_capacity;
+} symbols_table_t;
+
+void symbols_table_init(symbols_table_t *symbols_table);
+void symbols_table_destroy(symbols_table_t *symbols_table);
+void symbols_table_add(symbols_table_t *symbols_table, int id, int value, int line_number);
+symbol_t* symbols_table_search(symbols_table_t *symbols_table, int id);
+void symbols_table_define(symbols_table_t *symbols_table, int id, int value);
+int symbols_table_has_undefined(symbols_table_t *symbols_table);
+int symbols_table_next_undefined(symbols_table_t *symbols_table, int id);
+void symbols_table_add_fixup(symbols_table_t *symbols_table, int id, int position,
+                             int offset, int opcode, int line_number, int is_write);
+void symbols_table_group_fixups(symbols_table_t *symbols_table);
+fixup_t* symbols_table_fixup(symbols_table_t *symbols_table, int index);
 
-#endif /* _SYMBOLS_TABLE_H_ */
\ No newline at end of file
+#endif /* _SYMBOLS_TABLE_H_ */
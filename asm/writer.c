@@ -0,0 +1,178 @@
+/**
+ * @file   writer.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Implements the buffered text writer
+ */
+
+#include "writer.h"
+
+/**
+ * Open a file for writing through a buffer. An error cleanup is pushed for the writer, so
+ * the file is closed and removed if an error stops writing it within an assembly context.
+ * @param filename Name of the output file, which must be valid until the writer is
+ *                 closed.
+ * @return pointer to the writer, to be released with writer_close.
+ */
+writer_t* writer_open(char *filename)
+{
+    writer_t *writer = malloc(sizeof(writer_t));
+    
+    if (!writer)
+        error(ERROR_FILE, "Cannot allocate memory for writing %s", filename);
+    
+    writer->fp = NULL;
+    writer->filename = filename;
+    writer->buffer = malloc(WRITER_BUFFER_SIZE);
+    writer->length = 0;
+    
+    context_push_cleanup(writer_cleanup, writer);
+    
+    if (!writer->buffer)
+        error(ERROR_FILE, "Cannot allocate memory for writing %s", filename);
+    
+    writer->fp = file_open(filename, "w");
+    
+    return writer;
+}
+
+/**
+ * Write the characters left in the buffer and close the file, releasing the writer.
+ * @param writer Pointer to a writer struct.
+ */
+void writer_close(writer_t *writer)
+{
+    writer_flush(writer);
+    
+    if (fclose(writer->fp) != 0)
+    {
+        writer->fp = NULL;
+        error(ERROR_FILE, "Cannot write to file %s", writer->filename);
+    }
+    
+    writer->fp = NULL;
+    writer->filename = NULL;
+    writer_destroy(writer);
+}
+
+/**
+ * Release a writer. A file which was not closed is closed and removed, since it is
+ * incomplete.
+ * @param writer Pointer to a writer struct.
+ */
+void writer_destroy(writer_t *writer)
+{
+    context_pop_cleanup(writer);
+    
+    if (writer->fp)
+        fclose(writer->fp);
+    
+    if (writer->filename)
+        remove(writer->filename);
+    
+    free(writer->buffer);
+    free(writer);
+}
+
+/**
+ * Error cleanup of a writer.
+ * @param writer Pointer to a writer struct.
+ */
+void writer_cleanup(void *writer)
+{
+    writer_destroy(writer);
+}
+
+/**
+ * Write the characters in the buffer to the file, emptying it.
+ * @param writer Pointer to a writer struct.
+ */
+void writer_flush(writer_t *writer)
+{
+    if (writer->length == 0)
+        return;
+    
+    if (fwrite(writer->buffer, 1, writer->length, writer->fp) != (size_t)writer->length)
+        error(ERROR_FILE, "Cannot write to file %s", writer->filename);
+    
+    writer->length = 0;
+}
+
+/**
+ * Write a character.
+ * @param writer Pointer to a writer struct.
+ * @param c Character.
+ */
+void writer_put_char(writer_t *writer, char c)
+{
+    if (writer->length == WRITER_BUFFER_SIZE)
+        writer_flush(writer);
+    
+    writer->buffer[writer->length++] = c;
+}
+
+/**
+ * Write a string, which may be longer than the buffer.
+ * @param writer Pointer to a writer struct.
+ * @param str String, which does not need to be null-terminated.
+ * @param length Number of characters of the string.
+ */
+void writer_put_string(writer_t *writer, const char *str, int length)
+{
+    int block;
+    
+    while (length > 0)
+    {
+        if (writer->length == WRITER_BUFFER_SIZE)
+            writer_flush(writer);
+        
+        block = WRITER_BUFFER_SIZE - writer->length;
+        if (block > length)
+            block = length;
+        
+        memcpy(&writer->buffer[writer->length], str, block);
+        writer->length += block;
+        str += block;
+        length -= block;
+    }
+}
+
+/**
+ * Write a number of spaces, for aligning columns.
+ * @param writer Pointer to a writer struct.
+ * @param count Number of spaces, which writes nothing when not positive.
+ */
+void writer_put_spaces(writer_t *writer, int count)
+{
+    for (; count > 0; --count)
+        writer_put_char(writer, ' ');
+}
+
+/**
+ * Write an integer in decimal, right-aligned in a column. Its digits are produced from
+ * the last one, at the end of a small array, and then copied at once.
+ * @param writer Pointer to a writer struct.
+ * @param value Integer.
+ * @param width Minimum number of characters, padded with spaces on the left.
+ */
+void writer_put_int(writer_t *writer, long value, int width)
+{
+    char digits[WRITER_INT_SIZE];
+    char *p = digits + WRITER_INT_SIZE;
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : (unsigned long)value;
+    int length;
+    
+    do
+    {
+        *--p = '0' + (char)(magnitude%10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    
+    if (value < 0)
+        *--p = '-';
+    
+    length = digits + WRITER_INT_SIZE - p;
+    writer_put_spaces(writer, width - length);
+    writer_put_string(writer, p, length);
+}
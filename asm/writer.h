@@ -0,0 +1,64 @@
+/**
+ * @file   writer.h
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Declares the buffered text writer
+ *
+ * A writer collects text in one large buffer and only writes it to its file once the
+ * buffer is full or the writer is closed, so writing many short fields costs a few system
+ * calls. Integers are formatted by hand, straight into the buffer, instead of parsing a
+ * format string for each one as printf does.
+ *
+ * Example usage
+ *
+    writer_t *writer = writer_open("listing.lst");
+    
+    writer_put_string(writer, "Size:", 5);
+    writer_put_int(writer, size, 6);
+    writer_put_char(writer, '\n');
+    writer_close(writer);
+ */
+
+#ifndef _WRITER_H_
+#define _WRITER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "file.h"
+#include "context.h"
+
+/* Number of characters kept in memory before writing them to the file */
+#define WRITER_BUFFER_SIZE (64*1024)
+
+/* Enough characters for any long integer, with its sign */
+#define WRITER_INT_SIZE 24
+
+/*
+ * A writer struct contains the following fields:
+ * - fp: Output file, or NULL once closed.
+ * - filename: Name of the output file, which is removed if an error stops writing it.
+ * - buffer: Characters not written to the file yet.
+ * - length: Number of characters in buffer.
+ */
+typedef struct
+{
+    FILE *fp;
+    char *filename;
+    char *buffer;
+    int length;
+} writer_t;
+
+writer_t* writer_open(char *filename);
+void writer_close(writer_t *writer);
+void writer_destroy(writer_t *writer);
+void writer_cleanup(void *writer);
+void writer_flush(writer_t *writer);
+void writer_put_char(writer_t *writer, char c);
+void writer_put_string(writer_t *writer, const char *str, int length);
+void writer_put_spaces(writer_t *writer, int count);
+void writer_put_int(writer_t *writer, long value, int width);
+
+#endif /* _WRITER_H_ */
@@ -10,31 +10,68 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include <object_file.h>
+#include <object_format.h>
 
 #define DEBUG 0
+#define MEMORY_SIZE 0x10000 /* Whole 16-bit address space */
 
-obj_t memory[1000];
+/*
+ * Zero-initialized, so BSS needs no work when loading. Two extra words keep operand
+ * fetches at the last addresses inside the array.
+ */
+obj_t memory[MEMORY_SIZE + 2];
 short int acc = 0; /* short int register */
 uint16_t pc = 0; /* 16 bit program counter */
 
-void object_file_read(char *filename, object_file_t *object_ptr)
+/**
+ * Map and validate an object file, then copy its sections straight from the mapping to the
+ * memory. BSS needs no work, since the memory is already zero.
+ * @param filename Name of the object file.
+ * @param image Image receiving the object file header. Its tables point to the mapping,
+ *              which is released before returning.
+ */
+void load_program(char *filename, object_image_t *image)
 {
-    FILE *fp = fopen(filename, "rb");
+    object_mapping_t mapping;
+    int status;
     int i;
     
-    fread(&object_ptr->size, sizeof(int), 1, fp); /* First word is the program size */
-    fread(&object_ptr->text_section_address, sizeof(int), 1, fp); /* Second word is the text section address */
+    status = object_format_map(filename, &mapping);
+    if (status == OBJECT_FORMAT_OK)
+        status = object_format_parse(mapping.data, mapping.length, image);
+    if (status != OBJECT_FORMAT_OK)
+    {
+        fprintf(stderr, "ERROR: %s \"%s\"\n", object_format_strerror(status), filename);
+        exit(1);
+    }
     
-    object_ptr->program = malloc(sizeof(obj_t)*object_ptr->size);
-    fread(object_ptr->program, sizeof(obj_t), object_ptr->size, fp);
+    if (object_format_image_size(image) > MEMORY_SIZE)
+    {
+        fprintf(stderr, "ERROR: Program does not fit in memory\n");
+        exit(1);
+    }
+    
+    for (i = 0; i < OBJECT_SECTION_BSS; ++i)
+        object_format_load_section(image, i, &memory[image->sections[i].address]);
     
     printf("\n===== %s =====\n\n", filename);
-    for (i = 0; i < object_ptr->size; ++i)
-        printf("(addr. %d): %d\n", i, object_ptr->program[i]);
+    printf("Text: %d words at %d\n", image->sections[OBJECT_SECTION_TEXT].size,
+           image->sections[OBJECT_SECTION_TEXT].address);
+    printf("Data: %d words at %d\n", image->sections[OBJECT_SECTION_DATA].size,
+           image->sections[OBJECT_SECTION_DATA].address);
+    printf("BSS: %d words at %d\n", image->sections[OBJECT_SECTION_BSS].size,
+           image->sections[OBJECT_SECTION_BSS].address);
+    if (DEBUG)
+        for (i = 0; i < object_format_image_size(image); ++i)
+            printf("(addr. %d): %d\n", i, memory[i]);
     printf("\n==========\n");
     
-    fclose(fp);
+    object_format_unmap(&mapping);
+    for (i = 0; i < OBJECT_SECTION_COUNT; ++i)
+        image->sections[i].data = NULL;
+    image->symbol_data = NULL;
+    image->relocation_data = NULL;
+    image->strings = NULL;
 }
 
 void add()
@@ -167,9 +204,8 @@ void output()
 int main(int argc, char **argv)
 {
     char *filename;
-    int i;
     int stop_flag = 0;
-    object_file_t obj;
+    object_image_t image;
     
     /* Parse command line arguments */
     if (argc != 2)
@@ -181,14 +217,12 @@ int main(int argc, char **argv)
     filename = argv[1];
     
     /* Load program to the memory */
-    object_file_read(filename, &obj);
+    load_program(filename, &image);
     printf("Loading program... ");
-    for (i = 0; i < obj.size; ++i)
-        memory[i] = obj.program[i];
     printf("OK!\n\n");
     
-    /* Setting PC to the text section address */
-    pc = obj.text_section_address;
+    /* Setting PC to the entry point, at the text section */
+    pc = image.entry;
     
     while (stop_flag != 1)
     {
@@ -200,7 +234,7 @@ int main(int argc, char **argv)
             printf("=====\n\n");
         }
         
-        switch (obj.program[pc])
+        switch (memory[pc])
         {
             case 0x1:
                 add();
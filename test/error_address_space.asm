@@ -0,0 +1,7 @@
+SECTION TEXT
+	LOAD Y
+	STOP
+
+SECTION DATA
+Y:	CONST 4
+Z:	SPACE 70000 ; Erro por programa maior que o espaço de endereçamento
@@ -0,0 +1,28 @@
+; Vários erros, encontrados fora da ordem das linhas. Montar com --keep-going para ver
+; todos ordenados por linha, ou com --max-errors 3 para parar ao atingir o limite.
+SECTION TEXT
+	COPY ZERO, OLDER
+	COPY TWO, TWO ; Erro por label não definido, reportado uma só vez para a linha
+	INPUT LIMIT
+	OUTPUT OLD
+FRONT:	LOAD OLDER
+	ADD 1OLD ; Erro por token inválido (não pode iniciar com número)
+	STORE NEW
+	SUB LIMIT
+	JMPP FINAL
+	OUTPUT NEW
+	COPY OLD, OLDER
+	COPY NEW, OLD
+	JMP FRONT
+FINAL:	OUTPUT LIMIT
+	JMP END ; Erro por label não definido
+	STOP
+
+SECTION DATA
+ZERO:	CONST 0
+ZERO:   CONST 0 ; Erro por redefinição de label
+ONE:	CONST 1
+OLDER:	SPACE
+OLD:	SPACE
+NEW:	SPACE
+LIMIT:	SPACE
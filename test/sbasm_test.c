@@ -0,0 +1,280 @@
+/**
+ * @file   sbasm_test.c
+ * @author sb-assembler contributors
+ * @date   16/10/2026
+ *
+ * @brief  Checks the assembler library on a good and a bad source, and on a large source
+ *         scanned in chunks
+ *
+ * Built and run with "make test". It includes nothing but the library header, and defines
+ * functions named as internal ones of the assembler, which must not clash with the library.
+ * The exit code is the number of failed checks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sbasm.h"
+
+/* Number of blocks of the large source, which is scanned in chunks */
+#define LARGE_SOURCE_BLOCKS 4000
+
+/* Same names as functions of the assembler, which the library must keep to itself */
+int is_number(double value);
+FILE* file_open(const char *name);
+
+int check(int condition, const char *description);
+int test_good_source(void);
+int test_bad_source(void);
+int test_chunked_scan(void);
+char* make_large_source(size_t *len);
+
+const char *good_source =
+    "SECTION TEXT\n"
+    "\tINPUT N\n"
+    "\tLOAD N\n"
+    "\tADD ONE\n"
+    "\tSTORE N\n"
+    "\tOUTPUT N\n"
+    "\tSTOP\n"
+    "SECTION DATA\n"
+    "N:\tSPACE\n"
+    "ONE:\tCONST 1\n";
+
+const char *bad_source =
+    "SECTION TEXT\n"
+    "\tCOPY TWO, TWO\n"
+    "\tLOAD 1N\n"
+    "\tJMP END\n"
+    "\tSTOP\n"
+    "SECTION DATA\n"
+    "N:\tSPACE\n"
+    "N:\tCONST 1\n";
+
+int main(void)
+{
+    int failures = 0;
+    
+    failures += test_good_source();
+    failures += test_bad_source();
+    failures += test_chunked_scan();
+    failures += !check(is_number(1.0) && (file_open("none") == NULL),
+                       "host functions named as internal ones are called");
+    
+    printf("%d check(s) failed\n", failures);
+    return failures;
+}
+
+/**
+ * Stand-in for a host function sharing a name with the assembler.
+ * @param value Any number.
+ * @return 1 for positive numbers, 0 otherwise.
+ */
+int is_number(double value)
+{
+    return value > 0;
+}
+
+/**
+ * Stand-in for a host function sharing a name with the assembler.
+ * @param name Any name.
+ * @return NULL.
+ */
+FILE* file_open(const char *name)
+{
+    return NULL;
+}
+
+/**
+ * Print the outcome of a check.
+ * @param condition Whether the check passed.
+ * @param description What was checked.
+ * @return condition.
+ */
+int check(int condition, const char *description)
+{
+    printf("%s: %s\n", condition ? "PASS" : "FAIL", description);
+    return condition;
+}
+
+/**
+ * Assemble a correct source, which must give an object file and no diagnostics.
+ * @return Number of failed checks.
+ */
+int test_good_source(void)
+{
+    sbasm_result_t result;
+    int failures = 0;
+    int status;
+    
+    status = sbasm_assemble(good_source, strlen(good_source), NULL, &result);
+    
+    failures += !check(status == SBASM_OK, "good source is assembled");
+    failures += !check((result.object != NULL) && (result.object_size > 4) &&
+                       (memcmp(result.object, "SBOB", 4) == 0),
+                       "good source gives an object file");
+    failures += !check(result.diagnostic_count == 0, "good source has no diagnostics");
+    failures += !check(result.progress == NULL, "progress is not kept by default");
+    
+    sbasm_result_free(&result);
+    failures += !check((result.object == NULL) && (result.diagnostics == NULL),
+                       "result is cleared when freed");
+    
+    return failures;
+}
+
+/**
+ * Assemble a source with several errors, first stopping at the first one, then keeping
+ * going and stopping at the cap.
+ * @return Number of failed checks.
+ */
+int test_bad_source(void)
+{
+    sbasm_options_t options;
+    sbasm_result_t result;
+    int failures = 0;
+    int is_sorted = 1;
+    int status;
+    int i;
+    
+    status = sbasm_assemble(bad_source, strlen(bad_source), NULL, &result);
+    
+    failures += !check(status == SBASM_ERROR_LEXICAL, "bad source fails at its first error");
+    failures += !check((result.object == NULL) && (result.object_size == 0),
+                       "bad source gives no object file");
+    failures += !check((result.diagnostic_count == 1) &&
+                       (result.diagnostics[0].type == SBASM_ERROR_LEXICAL) &&
+                       (result.diagnostics[0].line_number == 3),
+                       "first error is reported at its line");
+    
+    sbasm_result_free(&result);
+    
+    sbasm_options_init(&options);
+    options.max_errors = 100;
+    status = sbasm_assemble(bad_source, strlen(bad_source), &options, &result);
+    
+    failures += !check(status == SBASM_ERROR_LEXICAL,
+                       "keeping going returns the type of the first error found");
+    failures += !check((result.object == NULL) && (result.object_size == 0),
+                       "keeping going gives no object file");
+    failures += !check((result.diagnostic_count == 5) &&
+                       (result.diagnostics[0].line_number == 2) &&
+                       (result.diagnostics[0].type == SBASM_ERROR_SEMANTIC) &&
+                       (result.diagnostics[4].line_number == 8),
+                       "every error is reported once, sorted by line");
+    
+    for (i = 1; (i < result.diagnostic_count) && is_sorted; ++i)
+        is_sorted = result.diagnostics[i - 1].line_number <= result.diagnostics[i].line_number;
+    
+    failures += !check(is_sorted, "errors are sorted by line");
+    
+    sbasm_result_free(&result);
+    
+    options.max_errors = 2;
+    status = sbasm_assemble(bad_source, strlen(bad_source), &options, &result);
+    
+    failures += !check((status != SBASM_OK) && (result.diagnostic_count == 2),
+                       "keeping going stops at the cap");
+    
+    sbasm_result_free(&result);
+    
+    return failures;
+}
+
+/**
+ * Assemble a large source scanned in several numbers of chunks, which must give the same
+ * object file, byte for byte, and the same diagnostics as scanning it sequentially.
+ * @return Number of failed checks.
+ */
+int test_chunked_scan(void)
+{
+    static const int chunk_counts[] = {2, 3, 7, 64};
+    sbasm_options_t options;
+    sbasm_result_t sequential;
+    sbasm_result_t chunked;
+    char *source;
+    size_t len;
+    int is_same;
+    int i;
+    
+    source = make_large_source(&len);
+    
+    sbasm_options_init(&options);
+    options.scan_chunks = 1;
+    is_same = (sbasm_assemble(source, len, &options, &sequential) == SBASM_OK);
+    
+    for (i = 0; i < (int)(sizeof(chunk_counts)/sizeof(chunk_counts[0])); ++i)
+    {
+        options.scan_chunks = chunk_counts[i];
+        sbasm_assemble(source, len, &options, &chunked);
+        
+        is_same = is_same && (chunked.object_size == sequential.object_size) &&
+            (memcmp(chunked.object, sequential.object, sequential.object_size) == 0);
+        
+        sbasm_result_free(&chunked);
+    }
+    
+    sbasm_result_free(&sequential);
+    
+    /* An error at the last line must be reported at the same line in every chunk */
+    strcpy(source + len, "\tJMP NOWHERE\n");
+    len += strlen(source + len);
+    options.max_errors = 10;
+    options.scan_chunks = 1;
+    sbasm_assemble(source, len, &options, &sequential);
+    
+    for (i = 0; i < (int)(sizeof(chunk_counts)/sizeof(chunk_counts[0])); ++i)
+    {
+        options.scan_chunks = chunk_counts[i];
+        sbasm_assemble(source, len, &options, &chunked);
+        
+        is_same = is_same && (chunked.diagnostic_count == sequential.diagnostic_count) &&
+            (chunked.diagnostic_count > 0) &&
+            (chunked.diagnostics[0].line_number == sequential.diagnostics[0].line_number);
+        
+        sbasm_result_free(&chunked);
+    }
+    
+    sbasm_result_free(&sequential);
+    free(source);
+    
+    return !check(is_same, "scanning in chunks gives the same output as sequentially");
+}
+
+/**
+ * Make a large source, with comments, equates used before their definition and IF blocks
+ * all along, so it is split in chunks at many kinds of lines.
+ * @param len Stores the number of characters of the source.
+ * @return Source code, with room for one more line, which must be freed.
+ */
+char* make_large_source(size_t *len)
+{
+    const char *block =
+        "; block %d\n"
+        "L%d:\tLOAD N ; keep the sum\n"
+        "\tIF FLAG\n"
+        "\tADD ONE\n"
+        "\tIF ZERO\n"
+        "\tSUB ONE\n"
+        "\tSTORE N\n";
+    const char *end =
+        "\tSTOP\n"
+        "SECTION DATA\n"
+        "N:\tSPACE\n"
+        "ONE:\tCONST 1\n"
+        "FLAG:\tEQU 1\n"
+        "ZERO:\tEQU 0\n";
+    char *source = malloc(LARGE_SOURCE_BLOCKS*(strlen(block) + 20) + strlen(end) + 64);
+    size_t size;
+    int i;
+    
+    size = sprintf(source, "SECTION TEXT\n");
+    
+    for (i = 0; i < LARGE_SOURCE_BLOCKS; ++i)
+        size += sprintf(source + size, block, i, i);
+    
+    strcpy(source + size, end);
+    *len = size + strlen(end);
+    
+    return source;
+}